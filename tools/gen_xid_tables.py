@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+#  ---------------------------------------------
+#  Generates the XID tables of unicode_text.hpp
+#  ---------------------------------------------
+#  Rewrites the region between the 'generated' markers of the header:
+#  the XID_Start/XID_Continue ranges and the two level trie looked up
+#  by is_xid_start() and is_xid_continue(), so that the compiler has
+#  nothing to compute. The ranges are taken from the header itself,
+#  or from the Unicode Character Database if given:
+#
+#    python3 tools/gen_xid_tables.py [DerivedCoreProperties.txt]
+#
+#  https://www.unicode.org/Public/UCD/latest/ucd/DerivedCoreProperties.txt
+#  ---------------------------------------------
+import re
+import sys
+from pathlib import Path
+
+HEADER = Path(__file__).resolve().parent.parent / 'unicode_text.hpp'
+BEGIN_MARK = '    // [generated by tools/gen_xid_tables.py, do not edit]\n'
+END_MARK = '    // [end of generated]\n'
+BLOCK_SIZE = 256
+BLOCKS_COUNT = 0x110000 // BLOCK_SIZE
+INDENT = ' ' * 8
+
+
+#----------------------------------------------------------------------------
+def ranges_from_ucd(path):
+    """The XID_Start and XID_Continue ranges and the Unicode version"""
+    text = Path(path).read_text(encoding='utf-8')
+    version = re.search(r'DerivedCoreProperties-(\d+\.\d+)', text).group(1)
+    ranges = {'XID_Start': [], 'XID_Continue': []}
+    for line in text.splitlines():
+        m = re.match(r'([0-9A-F]+)(?:\.\.([0-9A-F]+))?\s*;\s*(XID_Start|XID_Continue)\b', line)
+        if m:
+            first = int(m.group(1), 16)
+            last = int(m.group(2), 16) if m.group(2) else first
+            ranges[m.group(3)].append((first, last))
+    return merged(ranges['XID_Start']), merged(ranges['XID_Continue']), version
+
+
+#----------------------------------------------------------------------------
+def ranges_from_header(src):
+    """The ranges currently in the header and their Unicode version"""
+    def parse(name):
+        m = re.search(name + r'\[\] =\s*\{(.*?)\};', src, re.S)
+        return [(int(a, 16), int(b, 16)) for a, b in re.findall(r'\{0x([0-9A-F]+),0x([0-9A-F]+)\}', m.group(1))]
+    version = re.search(r'XID_Continue properties \(Unicode (\d+\.\d+)\)', src).group(1)
+    return parse('xid_start_ranges'), parse('xid_continue_ranges'), version
+
+
+#----------------------------------------------------------------------------
+def merged(ranges):
+    result = []
+    for first, last in sorted(ranges):
+        if result and first<=result[-1][1]+1:
+            result[-1] = (result[-1][0], max(last, result[-1][1]))
+        else:
+            result.append((first, last))
+    return result
+
+
+#----------------------------------------------------------------------------
+def block_bits(ranges):
+    """The bitmap of each block of codepoints, as four 64 bit words"""
+    bits = [0] * BLOCKS_COUNT
+    for first, last in ranges:
+        for cp in range(first, last+1):
+            bits[cp // BLOCK_SIZE] |= 1 << (cp % BLOCK_SIZE)
+    return [tuple((b >> (64*w)) & 0xFFFF_FFFF_FFFF_FFFF for w in range(4)) for b in bits]
+
+
+#----------------------------------------------------------------------------
+def build_trie(start_ranges, continue_ranges):
+    """The block index of each 256 codepoints and the distinct blocks, the first is the empty one"""
+    start_bits = block_bits(start_ranges)
+    continue_bits = block_bits(continue_ranges)
+    empty = ((0,)*4, (0,)*4)
+    blocks = [empty]
+    positions = {empty: 0}
+    index = []
+    for b in range(BLOCKS_COUNT):
+        block = (start_bits[b], continue_bits[b])
+        if block not in positions:
+            positions[block] = len(blocks)
+            blocks.append(block)
+        index.append(positions[block])
+    assert len(blocks)<=256, 'The block index is a byte'
+    return index, blocks
+
+
+#----------------------------------------------------------------------------
+def rows(items, per_row):
+    lines = [','.join(items[i:i+per_row]) for i in range(0, len(items), per_row)]
+    return ',\n'.join(INDENT + line for line in lines) + '\n'
+
+
+#----------------------------------------------------------------------------
+def generated(start_ranges, continue_ranges, version):
+    index, blocks = build_trie(start_ranges, continue_ranges)
+    def ranges_table(ranges):
+        return rows(['{0x%04X,0x%04X}' % r for r in ranges], 6)
+    def block(b):
+        return '{{%s},{%s}}' % (','.join('0x%016X' % w for w in b[0]), ','.join('0x%016X' % w for w in b[1]))
+    return (BEGIN_MARK +
+            f'    // Codepoints with the XID_Start and XID_Continue properties (Unicode {version})\n'
+             '    inline constexpr codepoint_range_t xid_start_ranges[] =\n'
+             '       {\n' + ranges_table(start_ranges) + '       };\n'
+             '\n'
+             '    // The continuation ones, that include the XID_Start ones\n'
+             '    inline constexpr codepoint_range_t xid_continue_ranges[] =\n'
+             '       {\n' + ranges_table(continue_ranges) + '       };\n'
+             '\n'
+             '    // The block of each 256 codepoints\n'
+             '    inline constexpr std::uint8_t xid_block_index[0x110000/xid_block_size] =\n'
+             '       {\n' + rows([str(i) for i in index], 32) + '       };\n'
+             '\n'
+             '    // The distinct blocks, the first is the empty one\n'
+            f'    inline constexpr xid_block_t xid_blocks[{len(blocks)}] =\n'
+             '       {\n' + rows([block(b) for b in blocks], 1) + '       };\n' +
+            END_MARK)
+
+
+#----------------------------------------------------------------------------
+def main():
+    src = HEADER.read_text(encoding='utf-8-sig')
+    begin = src.index(BEGIN_MARK)
+    end = src.index(END_MARK) + len(END_MARK)
+    start_ranges, continue_ranges, version = ranges_from_ucd(sys.argv[1]) if len(sys.argv)>1 else ranges_from_header(src)
+    src = src[:begin] + generated(start_ranges, continue_ranges, version) + src[end:]
+    HEADER.write_text(src, encoding='utf-8-sig')
+
+
+if __name__=='__main__':
+    main()
@@ -6,9 +6,23 @@
 //  ---------------------------------------------
 #include <cassert>
 #include <cstdint> // std::uint8_t, std::uint16_t, ...
+#include <cstring> // std::memcpy()
+#include <bit> // std::endian, std::byteswap()
+#include <iterator> // std::back_inserter(), std::output_iterator
+#include <ostream> // std::basic_ostream, std::ios_base::badbit
+#include <streambuf>
+#include <version>
+#if defined(__cpp_lib_format)
+  #include <format>
+#endif
 #include <utility> // std::unreachable()
 #include <string>
 #include <string_view>
+#include <vector>
+#include <array>
+#include <algorithm> // std::upper_bound()
+#include <memory> // std::unique_ptr
+#include <mutex> // std::once_flag, std::call_once()
 
 
 //:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -70,6 +84,60 @@ namespace details
         return static_cast<char>(dword & 0xFF);
        }
 
+    //-----------------------------------------------------------------------
+    // Load a 64 bit word from a (possibly unaligned) sequence of code units
+    template<typename T>
+    [[nodiscard]] inline std::uint64_t load_word(const T* const ptr) noexcept
+       {
+        std::uint64_t word;
+        std::memcpy(&word, ptr, sizeof(word));
+        return word;
+       }
+
+    //-----------------------------------------------------------------------
+    [[nodiscard]] constexpr bool are_all_ascii_bytes(const std::uint64_t word) noexcept
+       {
+        return (word & 0x8080'8080'8080'8080)==0;
+       }
+
+    //-----------------------------------------------------------------------
+    [[nodiscard]] constexpr bool are_all_ascii_units16(const std::uint64_t word) noexcept
+       {
+        return (word & 0xFF80'FF80'FF80'FF80)==0;
+       }
+
+    //-----------------------------------------------------------------------
+    // Store the leading ascii code units widened (or narrowed) to the
+    // output unit, stops at the first word containing a non ascii
+    // character. The destination is pre-sized: no capacity checks
+    // in the copy, that the compiler turns in a vectorized widening.
+    // Returns the number of units stored
+    template<typename InCharT, typename OutCharT>
+    [[nodiscard]] inline std::size_t store_ascii_run(const std::basic_string_view<InCharT> in, std::size_t& pos, OutCharT* const dst) noexcept
+       {
+        constexpr std::size_t units_per_word = sizeof(std::uint64_t) / sizeof(InCharT);
+        const std::size_t start = pos;
+        while( (pos+units_per_word)<=in.size() )
+           {
+            const std::uint64_t word = load_word(in.data()+pos);
+            if constexpr( sizeof(InCharT)==1 )
+               {
+                if( not are_all_ascii_bytes(word) ) break;
+               }
+            else
+               {
+                if( not are_all_ascii_units16(word) ) break;
+               }
+            OutCharT* const out = dst + (pos-start);
+            for( std::size_t i=0; i<units_per_word; ++i )
+               {
+                out[i] = static_cast<OutCharT>(in[pos+i]);
+               }
+            pos += units_per_word;
+           }
+        return pos - start;
+       }
+
 } //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
 
 
@@ -84,6 +152,21 @@ enum class Enc : std::uint8_t
    };
 
 
+//---------------------------------------------------------------------------
+[[nodiscard]] constexpr std::size_t code_unit_size_of(const Enc enc) noexcept
+   {
+    switch(enc)
+       {using enum Enc;
+        case UTF8:    return 1;
+        case UTF16LE:
+        case UTF16BE: return 2;
+        case UTF32LE:
+        case UTF32BE: return 4;
+       }
+    std::unreachable();
+   }
+
+
 namespace codepoint
 {
     inline static constexpr char32_t invalid = U'�'; // replacement character '\u{FFFD}'
@@ -109,6 +192,16 @@ namespace flag
 
 
 
+//---------------------------------------------------------------------------
+// Bytes tagged with their encoding
+struct encoded_view_t final
+   {
+    std::string_view bytes;
+    Enc enc;
+   };
+
+
+
 //---------------------------------------------------------------------------
 // auto [enc, bom_size] = utxt::detect_encoding_of(bytes);
 struct bom_ret_t final { Enc enc; std::uint8_t bom_size; };
@@ -166,48 +259,103 @@ template<Enc enc> constexpr char32_t extract_codepoint(const std::string_view by
 //    return bytes[pos++];
 //}
 
-//---------------------------------------------------------------------------
-template<> constexpr char32_t extract_codepoint<Enc::UTF8>(const std::string_view bytes, std::size_t& pos) noexcept
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace details
 {
-    assert( pos<bytes.size() );
-
-    if( (bytes[pos] & 0x80)==0 ) [[likely]]
+    /////////////////////////////////////////////////////////////////////////
+    // What a leading byte tells about its utf-8 sequence: the
+    // expected size (zero if can't start a sequence), the mask
+    // of its payload bits and the range allowed for the second
+    // byte, that rejects overlong sequences, surrogates and
+    // codepoints beyond U+10FFFF
+    struct utf8_lead_t final
        {
-        const char32_t codepoint = static_cast<char32_t>(bytes[pos]);
-        ++pos;
-        return codepoint;
-       }
+        std::uint8_t size;
+        std::uint8_t payload_mask;
+        std::uint8_t second_min;
+        std::uint8_t second_max;
+       };
 
-    else if( (pos+1)<bytes.size() and (bytes[pos] & 0xE0)==0xC0 and (bytes[pos+1] & 0xC0)==0x80 )
+    inline constexpr std::array<utf8_lead_t,256> utf8_leads = []() consteval
        {
-        const char32_t codepoint = static_cast<char32_t>((bytes[pos] & 0x1F) << 6) |
-                                   static_cast<char32_t>(bytes[pos+1] & 0x3F);
-        pos += 2;
-        return codepoint;
-       }
+        std::array<utf8_lead_t,256> leads{};
+        for( std::size_t byte=0; byte<256; ++byte )
+           {
+            leads[byte] = byte<0x80 ? utf8_lead_t{1, 0x7F, 0x80, 0xBF} // ascii
+                        : byte<0xC2 ? utf8_lead_t{0, 0x00, 0x80, 0xBF} // continuation or overlong
+                        : byte<0xE0 ? utf8_lead_t{2, 0x1F, 0x80, 0xBF}
+                        : byte==0xE0 ? utf8_lead_t{3, 0x0F, 0xA0, 0xBF} // No overlongs
+                        : byte==0xED ? utf8_lead_t{3, 0x0F, 0x80, 0x9F} // No surrogates
+                        : byte<0xF0 ? utf8_lead_t{3, 0x0F, 0x80, 0xBF}
+                        : byte==0xF0 ? utf8_lead_t{4, 0x07, 0x90, 0xBF} // No overlongs
+                        : byte<0xF4 ? utf8_lead_t{4, 0x07, 0x80, 0xBF}
+                        : byte==0xF4 ? utf8_lead_t{4, 0x07, 0x80, 0x8F} // Up to U+10FFFF
+                        : utf8_lead_t{0, 0x00, 0x80, 0xBF}; // Beyond U+10FFFF
+           }
+        return leads;
+       }();
 
-    else if( (pos+2)<bytes.size() and (bytes[pos] & 0xF0)==0xE0 and (bytes[pos+1] & 0xC0)==0x80 and (bytes[pos+2] & 0xC0)==0x80 )
+    //-----------------------------------------------------------------------
+    // The size of the complete and valid non ascii sequence starting
+    // at pos, zero if invalid or truncated. Just validates, no decoding
+    [[nodiscard]] constexpr std::size_t valid_utf8_seq_size(const std::string_view bytes, const std::size_t pos) noexcept
        {
-        const char32_t codepoint = static_cast<char32_t>((bytes[pos] & 0x0F) << 12) |
-                                   static_cast<char32_t>((bytes[pos+1] & 0x3F) << 6) |
-                                   static_cast<char32_t>(bytes[pos+2] & 0x3F);
-        pos += 3;
-        return codepoint;
+        assert( pos<bytes.size() and (bytes[pos] & 0x80)!=0 );
+        const utf8_lead_t lead = utf8_leads[static_cast<unsigned char>(bytes[pos])];
+        if( lead.size==0 or (pos+lead.size)>bytes.size() )
+           {
+            return 0;
+           }
+        const auto second = static_cast<unsigned char>(bytes[pos+1]);
+        if( second<lead.second_min or second>lead.second_max )
+           {
+            return 0;
+           }
+        for( std::size_t i=2; i<lead.size; ++i )
+           {
+            if( (bytes[pos+i] & 0xC0)!=0x80 ) return 0;
+           }
+        return lead.size;
        }
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
 
-    else if( (pos+3)<bytes.size() and (bytes[pos] & 0xF8)==0xF0 and (bytes[pos+1] & 0xC0)==0x80 and (bytes[pos+2] & 0xC0)==0x80 and (bytes[pos+3] & 0xC0)==0x80 )
+//---------------------------------------------------------------------------
+template<> constexpr char32_t extract_codepoint<Enc::UTF8>(const std::string_view bytes, std::size_t& pos) noexcept
+{
+    assert( pos<bytes.size() );
+
+    if( (bytes[pos] & 0x80)==0 ) [[likely]]
        {
-        const char32_t codepoint = static_cast<char32_t>((bytes[pos] & 0x07) << 18) |
-                                   static_cast<char32_t>((bytes[pos+1] & 0x3F) << 12) |
-                                   static_cast<char32_t>((bytes[pos+2] & 0x3F) << 6) |
-                                   static_cast<char32_t>(bytes[pos+3] & 0x3F);
-        pos += 4;
+        const char32_t codepoint = static_cast<char32_t>(bytes[pos]);
+        ++pos;
         return codepoint;
        }
 
-    // Invalid utf-8 character
-    ++pos;
-    return codepoint::invalid;
+    // Validate and decode the following three bytes all together,
+    // without branches depending on the sequence size: the bytes
+    // past the end are read as zeroes, never continuation bytes
+    const auto lead = static_cast<unsigned char>(bytes[pos]);
+    const details::utf8_lead_t& info = details::utf8_leads[lead];
+    const std::size_t remaining = bytes.size() - pos;
+    const std::uint32_t byte1 = remaining>1 ? static_cast<unsigned char>(bytes[pos+1]) : 0u;
+    const std::uint32_t byte2 = remaining>2 ? static_cast<unsigned char>(bytes[pos+2]) : 0u;
+    const std::uint32_t byte3 = remaining>3 ? static_cast<unsigned char>(bytes[pos+3]) : 0u;
+
+    // Size of the valid prefix of the sequence
+    const std::uint32_t valid1 = byte1>=info.second_min and byte1<=info.second_max;
+    const std::uint32_t valid2 = valid1 & ((byte2 & 0xC0u)==0x80u);
+    const std::uint32_t valid3 = valid2 & ((byte3 & 0xC0u)==0x80u);
+    const std::uint32_t valid_size = 1u + valid1 + valid2 + valid3;
+
+    const std::uint32_t size = info.size;
+    const bool complete = size>0 and valid_size>=size;
+    const std::uint32_t payload = ((lead & info.payload_mask) << 18u) | ((byte1 & 0x3Fu) << 12u) | ((byte2 & 0x3Fu) << 6u) | (byte3 & 0x3Fu);
+    const std::uint32_t unused_bits = 6u * (4u - (complete ? size : 1u));
+
+    // Invalid utf-8 character: skip the maximal valid subpart
+    // of the sequence (at least a byte)
+    pos += complete ? size : (size>0 ? valid_size : 1u);
+    return complete ? static_cast<char32_t>(payload >> unused_bits) : codepoint::invalid;
 }
 
 //---------------------------------------------------------------------------
@@ -262,6 +410,18 @@ template<> constexpr char32_t extract_codepoint<Enc::UTF16BE>(const std::string_
     return extract_next_codepoint_from_utf16<false>(bytes, pos);
 }
 
+//:::::::::::::::::::::::::::::::: details ::::::::::::::::::::::::::::::::::
+namespace details
+{
+    //-----------------------------------------------------------------------
+    // Surrogates and values beyond U+10FFFF are not codepoints,
+    // invalid as the sequences that would encode them in utf-8/16
+    [[nodiscard]] constexpr char32_t valid_or_invalid(const char32_t value) noexcept
+       {
+        return (value<0xD800 or (value>=0xE000 and value<0x110000)) ? value : codepoint::invalid;
+       }
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
+
 //---------------------------------------------------------------------------
 template<> constexpr char32_t extract_codepoint<Enc::UTF32LE>(const std::string_view bytes, std::size_t& pos) noexcept
 {
@@ -269,7 +429,7 @@ template<> constexpr char32_t extract_codepoint<Enc::UTF32LE>(const std::string_
 
     const char32_t codepoint = details::combine_chars(bytes[pos+3], bytes[pos+2], bytes[pos+1], bytes[pos]); // Little endian
     pos += 4;
-    return codepoint;
+    return details::valid_or_invalid(codepoint);
 }
 
 //---------------------------------------------------------------------------
@@ -279,47 +439,61 @@ template<> constexpr char32_t extract_codepoint<Enc::UTF32BE>(const std::string_
 
     const char32_t codepoint = details::combine_chars(bytes[pos], bytes[pos+1], bytes[pos+2], bytes[pos+3]); // Big endian
     pos += 4;
-    return codepoint;
+    return details::valid_or_invalid(codepoint);
 }
 
-
 //---------------------------------------------------------------------------
-// Encode: Write a codepoint according to encoding and endianness
-template<Enc enc> constexpr void append_codepoint(const char32_t codepoint, std::string& bytes) noexcept;
+// Decode: Extract a codepoint from native utf-16 code units
+constexpr char32_t extract_codepoint(const std::u16string_view units, std::size_t& pos) noexcept
+{
+    assert( pos<units.size() );
+
+    const char16_t codeunit1 = units[pos];
+    ++pos;
+
+    if( codeunit1<0xD800 or codeunit1>=0xE000 ) [[likely]]
+       {// Basic Multilingual Plane
+        return codeunit1;
+       }
+
+    else if( codeunit1>=0xDC00 or pos>=units.size() )
+       {// Not a first surrogate!
+        return codepoint::invalid;
+       }
+
+    // Here expecting the second codeunit
+    const char16_t codeunit2 = units[pos];
+    if( codeunit2<0xDC00 or codeunit2>=0xE000 ) [[unlikely]]
+       {// Not a second surrogate!
+        return codepoint::invalid;
+       }
+
+    // Ok, I have the two valid codeunits
+    ++pos;
+    return 0x10000 + static_cast<char32_t>((codeunit1 - 0xD800) << 0xA) + static_cast<char32_t>(codeunit2 - 0xDC00);
+}
 
-//---------------------------------------------------------------------------
-//template<> constexpr void append_codepoint<Enc::ANSI>(const char32_t codepoint, std::string& bytes) noexcept
-//{
-//    bytes += static_cast<char>(codepoint); // Narrowing!
-//}
 
 //---------------------------------------------------------------------------
-template<> constexpr void append_codepoint<Enc::UTF8>(const char32_t codepoint, std::string& bytes) noexcept
+// Number of bytes of a codepoint encoded as OUTENC
+template<Enc OUTENC>
+[[nodiscard]] constexpr std::size_t encoded_size_of(const char32_t codepoint) noexcept
 {
-    if( codepoint<0x80 ) [[likely]]
-       {
-        bytes.push_back( static_cast<char>(codepoint) );
-       }
-    else if( codepoint<0x800 )
+    if constexpr( OUTENC==Enc::UTF8 )
        {
-        bytes.push_back( static_cast<char>(0xC0 | (codepoint >> 6) ));
-        bytes.push_back( static_cast<char>(0x80 | (codepoint & 0x3F)) );
+        return codepoint<0x80 ? 1 : codepoint<0x800 ? 2 : codepoint<0x10000 ? 3 : 4;
        }
-    else if( codepoint<0x10000 )
+    else if constexpr( OUTENC==Enc::UTF16LE or OUTENC==Enc::UTF16BE )
        {
-        bytes.push_back( static_cast<char>(0xE0 | (codepoint >> 12)) );
-        bytes.push_back( static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)) );
-        bytes.push_back( static_cast<char>(0x80 | (codepoint & 0x3F)) );
+        return codepoint<0x10000 ? 2 : 4;
        }
     else
        {
-        bytes.push_back( static_cast<char>(0xF0 | (codepoint >> 18)) );
-        bytes.push_back( static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)) );
-        bytes.push_back( static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)) );
-        bytes.push_back( static_cast<char>(0x80 | (codepoint & 0x3F)) );
+        return 4;
        }
 }
 
+
 //---------------------------------------------------------------------------
 // Encode a codepoint outside Basic Multilingual Plane
 constexpr std::pair<std::uint16_t,std::uint16_t> encode_as_utf16(uint32_t codepoint) noexcept
@@ -330,60 +504,183 @@ constexpr std::pair<std::uint16_t,std::uint16_t> encode_as_utf16(uint32_t codepo
              static_cast<std::uint16_t>((codepoint & 0x3FF) + 0xDC00) };
 }
 
-//---------------------------------------------------------------------------
-template<> constexpr void append_codepoint<Enc::UTF16LE>(const char32_t codepoint, std::string& bytes) noexcept
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace details
 {
-    if( codepoint<0x10000 ) [[likely]]
+    //-----------------------------------------------------------------------
+    // Size of the utf-8 sequence by the number of significant bits
+    inline constexpr std::array<std::uint8_t,33> utf8_size_by_bits = []() consteval
+       {
+        std::array<std::uint8_t,33> sizes{};
+        for( std::size_t bits=0; bits<sizes.size(); ++bits )
+           {
+            sizes[bits] = bits<=7 ? 1 : bits<=11 ? 2 : bits<=16 ? 3 : 4;
+           }
+        return sizes;
+       }();
+    inline constexpr std::array<std::uint8_t,5> utf8_lead_marks = { 0x00, 0x00, 0xC0, 0xE0, 0xF0 };
+
+    //-----------------------------------------------------------------------
+    // The utf-8 bytes of a codepoint packed in a word, the first in the
+    // least significant byte. Computed without branches: all the
+    // continuation bytes are built and then shifted according to size
+    struct utf8_seq_t final { std::uint32_t packed_bytes; std::uint32_t size; };
+    [[nodiscard]] constexpr utf8_seq_t utf8_seq_of(const char32_t codepoint) noexcept
        {
-        const std::uint16_t codeunit = static_cast<std::uint16_t>(codepoint);
-        bytes.push_back( details::low_byte_of( codeunit) );
-        bytes.push_back( details::high_byte_of( codeunit ) );
+        const std::uint32_t cp = codepoint;
+        const std::uint32_t size = utf8_size_by_bits[static_cast<std::size_t>(std::bit_width(cp))];
+        const std::uint32_t continuations = 0x8080'8080u | ((cp & 0x3F) << 24) | (((cp >> 6) & 0x3F) << 16) | (((cp >> 12) & 0x3F) << 8) | ((cp >> 18) & 0x3F);
+        const std::uint32_t lead = (utf8_lead_marks[size] | (cp >> (6*(size-1)))) & 0xFF;
+        return { ((continuations >> (8*(4-size))) & ~0xFFu) | lead, size };
        }
-    else
+
+    //-----------------------------------------------------------------------
+    // Store the utf-8 sequence with a single write, the
+    // destination must have room for four bytes
+    inline std::size_t write_utf8(const char32_t codepoint, char* const dst) noexcept
        {
-        const auto codeunits = encode_as_utf16(codepoint);
-        bytes.push_back( details::low_byte_of( codeunits.first ) );
-        bytes.push_back( details::high_byte_of( codeunits.first ) );
-        bytes.push_back( details::low_byte_of( codeunits.second ) );
-        bytes.push_back( details::high_byte_of( codeunits.second ) );
+        const utf8_seq_t seq = utf8_seq_of(codepoint);
+        std::uint32_t packed_bytes = seq.packed_bytes;
+        if constexpr( std::endian::native==std::endian::big )
+           {
+            packed_bytes = std::byteswap(packed_bytes);
+           }
+        std::memcpy(dst, &packed_bytes, sizeof(packed_bytes));
+        return seq.size;
        }
-}
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
 
 //---------------------------------------------------------------------------
-template<> constexpr void append_codepoint<Enc::UTF16BE>(const char32_t codepoint, std::string& bytes) noexcept
+// Encode: Write a codepoint according to encoding and endianness
+// to an output iterator of bytes
+// utxt::encode_to<UTF16LE>(codepoint, std::back_inserter(bytes));
+template<Enc enc, std::output_iterator<char> OutputIt>
+constexpr OutputIt encode_to(const char32_t codepoint, OutputIt out)
 {
-    if( codepoint<0x10000 ) [[likely]]
+    using enum Enc;
+    //if constexpr( enc==ANSI )
+    //   {
+    //    *out++ = static_cast<char>(codepoint); // Narrowing!
+    //   }
+    if constexpr( enc==UTF8 )
        {
-        const std::uint16_t codeunit = static_cast<std::uint16_t>(codepoint);
-        bytes.push_back( details::high_byte_of( codeunit ) );
-        bytes.push_back( details::low_byte_of( codeunit) );
+        if( codepoint<0x80 ) [[likely]]
+           {
+            *out++ = static_cast<char>(codepoint);
+           }
+        else
+           {
+            const details::utf8_seq_t seq = details::utf8_seq_of(codepoint);
+            for( std::size_t i=0; i<seq.size; ++i )
+               {
+                *out++ = static_cast<char>((seq.packed_bytes >> (8*i)) & 0xFF);
+               }
+           }
        }
-    else
+    else if constexpr( enc==UTF16LE )
        {
-        const auto codeunits = encode_as_utf16(codepoint);
-        bytes.push_back( details::high_byte_of( codeunits.first ) );
-        bytes.push_back( details::low_byte_of( codeunits.first ) );
-        bytes.push_back( details::high_byte_of( codeunits.second ) );
-        bytes.push_back( details::low_byte_of( codeunits.second ) );
+        if( codepoint<0x10000 ) [[likely]]
+           {
+            const std::uint16_t codeunit = static_cast<std::uint16_t>(codepoint);
+            *out++ = details::low_byte_of( codeunit );
+            *out++ = details::high_byte_of( codeunit );
+           }
+        else
+           {
+            const auto codeunits = encode_as_utf16(codepoint);
+            *out++ = details::low_byte_of( codeunits.first );
+            *out++ = details::high_byte_of( codeunits.first );
+            *out++ = details::low_byte_of( codeunits.second );
+            *out++ = details::high_byte_of( codeunits.second );
+           }
+       }
+    else if constexpr( enc==UTF16BE )
+       {
+        if( codepoint<0x10000 ) [[likely]]
+           {
+            const std::uint16_t codeunit = static_cast<std::uint16_t>(codepoint);
+            *out++ = details::high_byte_of( codeunit );
+            *out++ = details::low_byte_of( codeunit );
+           }
+        else
+           {
+            const auto codeunits = encode_as_utf16(codepoint);
+            *out++ = details::high_byte_of( codeunits.first );
+            *out++ = details::low_byte_of( codeunits.first );
+            *out++ = details::high_byte_of( codeunits.second );
+            *out++ = details::low_byte_of( codeunits.second );
+           }
        }
+    else if constexpr( enc==UTF32LE )
+       {
+        *out++ = details::ll_byte_of( codepoint );
+        *out++ = details::lh_byte_of( codepoint );
+        *out++ = details::hl_byte_of( codepoint );
+        *out++ = details::hh_byte_of( codepoint );
+       }
+    else if constexpr( enc==UTF32BE )
+       {
+        *out++ = details::hh_byte_of( codepoint );
+        *out++ = details::hl_byte_of( codepoint );
+        *out++ = details::lh_byte_of( codepoint );
+        *out++ = details::ll_byte_of( codepoint );
+       }
+    return out;
 }
 
 //---------------------------------------------------------------------------
-template<> constexpr void append_codepoint<Enc::UTF32LE>(const char32_t codepoint, std::string& bytes) noexcept
+// Encode: Append a codepoint according to encoding and endianness
+template<Enc enc> constexpr void append_codepoint(const char32_t codepoint, std::string& bytes) noexcept
 {
-    bytes.push_back( details::ll_byte_of( codepoint ) );
-    bytes.push_back( details::lh_byte_of( codepoint ) );
-    bytes.push_back( details::hl_byte_of( codepoint ) );
-    bytes.push_back( details::hh_byte_of( codepoint ) );
+    if constexpr( enc==Enc::UTF8 )
+       {// Just one capacity check
+        const details::utf8_seq_t seq = details::utf8_seq_of(codepoint);
+        const char seq_bytes[4] = { static_cast<char>(seq.packed_bytes & 0xFF),
+                                    static_cast<char>((seq.packed_bytes >> 8) & 0xFF),
+                                    static_cast<char>((seq.packed_bytes >> 16) & 0xFF),
+                                    static_cast<char>((seq.packed_bytes >> 24) & 0xFF) };
+        bytes.append(seq_bytes, seq.size);
+       }
+    else
+       {
+        encode_to<enc>(codepoint, std::back_inserter(bytes));
+       }
 }
 
+//:::::::::::::::::::::::::::::::: details ::::::::::::::::::::::::::::::::::
+namespace details
+{
+    //-----------------------------------------------------------------------
+    // Store a codepoint as native utf-16 code units in a pre-sized
+    // destination with room for two units, returns the units stored
+    inline std::size_t write_utf16(const char32_t codepoint, char16_t* const dst) noexcept
+       {
+        if( codepoint<0x10000 ) [[likely]]
+           {
+            dst[0] = static_cast<char16_t>(codepoint);
+            return 1;
+           }
+        const auto codeunits = encode_as_utf16(codepoint);
+        dst[0] = static_cast<char16_t>(codeunits.first);
+        dst[1] = static_cast<char16_t>(codeunits.second);
+        return 2;
+       }
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
+
 //---------------------------------------------------------------------------
-template<> constexpr void append_codepoint<Enc::UTF32BE>(const char32_t codepoint, std::string& bytes) noexcept
+// Encode a codepoint as native utf-16 code units
+constexpr void append_codepoint(const char32_t codepoint, std::u16string& units) noexcept
 {
-    bytes.push_back( details::hh_byte_of( codepoint ) );
-    bytes.push_back( details::hl_byte_of( codepoint ) );
-    bytes.push_back( details::lh_byte_of( codepoint ) );
-    bytes.push_back( details::ll_byte_of( codepoint ) );
+    if( codepoint<0x10000 ) [[likely]]
+       {
+        units.push_back( static_cast<char16_t>(codepoint) );
+       }
+    else
+       {
+        const auto codeunits = encode_as_utf16(codepoint);
+        units.push_back( static_cast<char16_t>(codeunits.first) );
+        units.push_back( static_cast<char16_t>(codeunits.second) );
+       }
 }
 
 
@@ -460,63 +757,462 @@ template<Enc ENC> class bytes_buffer_t final
 };
 
 
-// To instantiate the right template at runtime, so ugly...
-#define TEXT_DISPATCH_TO_ENC(E,L,...)\
-    switch(E)\
-       {using enum utxt::Enc;\
-        case UTF8: return L UTF8 __VA_ARGS__;\
-        case UTF16LE: return L UTF16LE __VA_ARGS__;\
-        case UTF16BE: return L UTF16BE __VA_ARGS__;\
-        case UTF32LE: return L UTF32LE __VA_ARGS__;\
-        case UTF32BE: return L UTF32BE __VA_ARGS__;\
-       }\
-    std::unreachable();
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace details
+{
+    //-----------------------------------------------------------------------
+    // The next codepoint of a buffer, a truncated one is invalid
+    inline constexpr char32_t end_of_text = 0xFFFF'FFFF; // Not a codepoint
+    template<Enc ENC>
+    [[nodiscard]] constexpr char32_t next_codepoint_of(utxt::bytes_buffer_t<ENC>& bytes_buf) noexcept
+       {
+        if( bytes_buf.has_codepoint() ) [[likely]]
+           {
+            return bytes_buf.extract_codepoint();
+           }
+        else if( bytes_buf.has_bytes() )
+           {// Truncated codepoint!
+            bytes_buf.set_as_depleted();
+            return codepoint::invalid;
+           }
+        return end_of_text;
+       }
 
+    //-----------------------------------------------------------------------
+    // Number of trailing bytes that form an incomplete codepoint,
+    // that could be completed by the bytes that follow
+    template<Enc ENC>
+    [[nodiscard]] constexpr std::size_t incomplete_tail_size(const std::string_view bytes) noexcept
+       {
+        if constexpr( ENC==Enc::UTF8 )
+           {// Search the leading byte among the last three
+            for( std::size_t n=1; n<=3 and n<=bytes.size(); ++n )
+               {
+                const auto byte = static_cast<unsigned char>(bytes[bytes.size()-n]);
+                if( (byte & 0xC0)!=0x80 )
+                   {// Not a continuation byte
+                    const std::size_t expected_size = (byte & 0xE0)==0xC0 ? 2 : (byte & 0xF0)==0xE0 ? 3 : (byte & 0xF8)==0xF0 ? 4 : 1;
+                    return expected_size>n ? n : 0;
+                   }
+               }
+            return 0;
+           }
+        else if constexpr( ENC==Enc::UTF16LE or ENC==Enc::UTF16BE )
+           {// A dangling byte, possibly after a first surrogate
+            const std::size_t odd = bytes.size() % 2;
+            if( bytes.size()>=(2+odd) )
+               {
+                const std::size_t i = bytes.size() - odd - 2;
+                const std::uint16_t codeunit = ENC==Enc::UTF16LE ? combine_chars(bytes[i+1], bytes[i]) : combine_chars(bytes[i], bytes[i+1]);
+                if( codeunit>=0xD800 and codeunit<0xDC00 )
+                   {
+                    return odd + 2;
+                   }
+               }
+            return odd;
+           }
+        else
+           {
+            return bytes.size() % 4;
+           }
+       }
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
 
 
-/// Re-encode bytes
 
-//---------------------------------------------------------------------------
-// Re-encode a byte buffer from INENC to OUTENC
-// const std::string out_bytes = utxt::reencode<UTF16LE,UTF8>(in_bytes);
-template<utxt::Enc INENC,utxt::Enc OUTENC>
-constexpr std::string reencode(const std::string_view in_bytes)
+/////////////////////////////////////////////////////////////////////////////
+// Sparse table of corresponding (output, input) offsets of a transcoding,
+// with a checkpoint every interval codepoints. The offsets in between
+// are found decoding the input from the nearest checkpoint
+// utxt::offset_map_t offsets;
+// const std::string out_bytes = utxt::reencode<UTF16LE,UTF8>(in_bytes, offsets);
+// const std::size_t in_offset = offsets.in_offset_of<UTF16LE,UTF8>(in_bytes, out_offset);
+class offset_map_t final
 {
-    std::string out_bytes;
+ public:
+    struct checkpoint_t final
+       {
+        std::size_t out_offset;
+        std::size_t in_offset;
+       };
 
-    // Preallocate the expected output bytes size
-    using enum utxt::Enc;
-    if constexpr( INENC==UTF8 and (OUTENC==UTF32BE or OUTENC==UTF32LE) ) // cppcheck-suppress redundantCondition
+ private:
+    std::vector<checkpoint_t> m_checkpoints{ {0,0} };
+    std::size_t m_interval; // Codepoints between checkpoints
+
+ public:
+    explicit offset_map_t(const std::size_t interval =64) noexcept
+      : m_interval{interval>0 ? interval : 1}
+       {}
+
+    [[nodiscard]] std::size_t interval() const noexcept { return m_interval; }
+    [[nodiscard]] const std::vector<checkpoint_t>& checkpoints() const noexcept { return m_checkpoints; }
+
+    void clear() noexcept
        {
-        out_bytes.reserve( 4 * in_bytes.size() );
+        m_checkpoints.resize(1);
        }
-    else if constexpr( (INENC==UTF16BE or INENC==UTF16LE) and (OUTENC==UTF32BE or OUTENC==UTF32LE) )
+
+    void add_checkpoint(const std::size_t out_offset, const std::size_t in_offset)
        {
-        out_bytes.reserve( 2 * in_bytes.size() );
+        assert( out_offset>=m_checkpoints.back().out_offset and in_offset>=m_checkpoints.back().in_offset );
+        if( out_offset!=m_checkpoints.back().out_offset or in_offset!=m_checkpoints.back().in_offset )
+           {
+            m_checkpoints.push_back({out_offset, in_offset});
+           }
        }
-    else if constexpr( INENC==UTF8 and (OUTENC==UTF16BE or OUTENC==UTF16LE) ) // cppcheck-suppress redundantCondition
+
+    //-----------------------------------------------------------------------
+    // The last checkpoint not beyond the given offset
+    [[nodiscard]] checkpoint_t nearest_by_out(const std::size_t out_offset) const noexcept
        {
-        out_bytes.reserve( 2 * in_bytes.size() );
+        const auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), out_offset,
+                                         [](const std::size_t offset, const checkpoint_t& cp) noexcept { return offset<cp.out_offset; });
+        return *(it-1);
        }
-    else
+    [[nodiscard]] checkpoint_t nearest_by_in(const std::size_t in_offset) const noexcept
        {
-        out_bytes.reserve( in_bytes.size() );
+        const auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), in_offset,
+                                         [](const std::size_t offset, const checkpoint_t& cp) noexcept { return offset<cp.in_offset; });
+        return *(it-1);
        }
 
-    utxt::bytes_buffer_t<INENC> bytes_buf(in_bytes);
-    while( bytes_buf.has_codepoint() )
+    //-----------------------------------------------------------------------
+    // After an edit of the input re-encoded between two unchanged
+    // boundaries: replaces the checkpoints in between and shifts
+    // the ones that follow to the new offsets
+    void splice(const checkpoint_t& from, const checkpoint_t& old_to, const checkpoint_t& new_to, const std::vector<checkpoint_t>& between)
        {
-        append_codepoint<OUTENC>(bytes_buf.extract_codepoint(), out_bytes);
+        auto by_in = [](const checkpoint_t& cp, const std::size_t offset) noexcept { return cp.in_offset<offset; };
+        const auto first = std::lower_bound(m_checkpoints.begin(), m_checkpoints.end(), from.in_offset+1, by_in);
+        const auto last = std::lower_bound(first, m_checkpoints.end(), old_to.in_offset, by_in);
+        for( auto it=last; it!=m_checkpoints.end(); ++it )
+           {
+            it->in_offset = it->in_offset - old_to.in_offset + new_to.in_offset;
+            it->out_offset = it->out_offset - old_to.out_offset + new_to.out_offset;
+           }
+        m_checkpoints.insert(m_checkpoints.erase(first, last), between.begin(), between.end());
        }
 
-    // Detect truncated
-    if( bytes_buf.has_bytes() )
-       {// Truncated codepoint!
-        append_codepoint<OUTENC>(codepoint::invalid, out_bytes);
+    //-----------------------------------------------------------------------
+    // The input offset of the codepoint containing the output offset
+    template<Enc INENC, Enc OUTENC>
+    [[nodiscard]] std::size_t in_offset_of(const std::string_view in_bytes, const std::size_t out_offset) const noexcept
+       {
+        return find_in_offset<INENC>(in_bytes, out_offset, encoded_size_of<OUTENC>);
+       }
+    // Same, for maps filled by to_utf32 (output offsets are indexes)
+    template<Enc INENC>
+    [[nodiscard]] std::size_t in_offset_of_index(const std::string_view in_bytes, const std::size_t out_index) const noexcept
+       {
+        return find_in_offset<INENC>(in_bytes, out_index, [](const char32_t) noexcept -> std::size_t { return 1; });
        }
 
-    return out_bytes;
-}
+    //-----------------------------------------------------------------------
+    // The output offset of the codepoint containing the input offset
+    template<Enc INENC, Enc OUTENC>
+    [[nodiscard]] std::size_t out_offset_of(const std::string_view in_bytes, const std::size_t in_offset) const noexcept
+       {
+        return find_out_offset<INENC>(in_bytes, in_offset, encoded_size_of<OUTENC>);
+       }
+    // Same, for maps filled by to_utf32 (output offsets are indexes)
+    template<Enc INENC>
+    [[nodiscard]] std::size_t out_index_of(const std::string_view in_bytes, const std::size_t in_offset) const noexcept
+       {
+        return find_out_offset<INENC>(in_bytes, in_offset, [](const char32_t) noexcept -> std::size_t { return 1; });
+       }
+
+ private:
+    template<Enc INENC, typename F>
+    [[nodiscard]] std::size_t find_in_offset(const std::string_view in_bytes, const std::size_t out_offset, const F out_size_of) const noexcept
+       {
+        const checkpoint_t cp = nearest_by_out(out_offset);
+        std::size_t out_pos = cp.out_offset;
+        utxt::bytes_buffer_t<INENC> bytes_buf(in_bytes);
+        bytes_buf.advance_of(cp.in_offset);
+        while( out_pos<out_offset and bytes_buf.has_bytes() )
+           {
+            const std::size_t in_pos = bytes_buf.byte_pos();
+            out_pos += out_size_of( details::next_codepoint_of(bytes_buf) );
+            if( out_pos>out_offset ) return in_pos; // The offset falls inside this codepoint
+           }
+        return bytes_buf.byte_pos();
+       }
+
+    template<Enc INENC, typename F>
+    [[nodiscard]] std::size_t find_out_offset(const std::string_view in_bytes, const std::size_t in_offset, const F out_size_of) const noexcept
+       {
+        const checkpoint_t cp = nearest_by_in(in_offset);
+        std::size_t out_pos = cp.out_offset;
+        utxt::bytes_buffer_t<INENC> bytes_buf(in_bytes);
+        bytes_buf.advance_of(cp.in_offset);
+        while( bytes_buf.byte_pos()<in_offset and bytes_buf.has_bytes() )
+           {
+            const char32_t codepoint = details::next_codepoint_of(bytes_buf);
+            if( bytes_buf.byte_pos()>in_offset ) break; // The offset falls inside this codepoint
+            out_pos += out_size_of(codepoint);
+           }
+        return out_pos;
+       }
+};
+
+
+
+// To instantiate the right template at runtime, so ugly...
+#define TEXT_DISPATCH_TO_ENC(E,L,...)\
+    switch(E)\
+       {using enum utxt::Enc;\
+        case UTF8: return L UTF8 __VA_ARGS__;\
+        case UTF16LE: return L UTF16LE __VA_ARGS__;\
+        case UTF16BE: return L UTF16BE __VA_ARGS__;\
+        case UTF32LE: return L UTF32LE __VA_ARGS__;\
+        case UTF32BE: return L UTF32BE __VA_ARGS__;\
+       }\
+    std::unreachable();
+
+
+
+/// Re-encode bytes
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace details
+{
+    //-----------------------------------------------------------------------
+    // The maximum size of the utf-8 output, an invalid byte may become '\uFFFD'
+    template<utxt::Enc INENC>
+    [[nodiscard]] constexpr std::size_t max_utf8_size(const std::size_t in_bytes_size) noexcept
+       {
+        using enum utxt::Enc;
+        if constexpr( INENC==UTF8 )
+           {
+            return 3 * in_bytes_size;
+           }
+        else if constexpr( INENC==UTF16LE or INENC==UTF16BE )
+           {
+            return 3 * (in_bytes_size/2) + 3;
+           }
+        else
+           {
+            return in_bytes_size + 3;
+           }
+       }
+
+    //-----------------------------------------------------------------------
+    // Preallocate the expected output bytes size
+    template<utxt::Enc INENC,utxt::Enc OUTENC>
+    [[nodiscard]] constexpr std::size_t expected_reencoded_size(const std::size_t in_bytes_size) noexcept
+       {
+        using enum utxt::Enc;
+        if constexpr( INENC==UTF8 and (OUTENC==UTF32BE or OUTENC==UTF32LE) ) // cppcheck-suppress redundantCondition
+           {
+            return 4 * in_bytes_size;
+           }
+        else if constexpr( (INENC==UTF16BE or INENC==UTF16LE) and (OUTENC==UTF32BE or OUTENC==UTF32LE) )
+           {
+            return 2 * in_bytes_size;
+           }
+        else if constexpr( INENC==UTF8 and (OUTENC==UTF16BE or OUTENC==UTF16LE) ) // cppcheck-suppress redundantCondition
+           {
+            return 2 * in_bytes_size;
+           }
+        else
+           {
+            return in_bytes_size;
+           }
+       }
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
+
+//---------------------------------------------------------------------------
+// Re-encode a byte buffer from INENC to OUTENC
+// const std::string out_bytes = utxt::reencode<UTF16LE,UTF8>(in_bytes);
+template<utxt::Enc INENC,utxt::Enc OUTENC>
+constexpr std::string reencode(const std::string_view in_bytes)
+{
+    std::string out_bytes;
+
+    if constexpr( OUTENC==Enc::UTF8 )
+       {
+        if !consteval
+           {// Write the sequences straight into a pre-sized output
+            out_bytes.resize_and_overwrite(details::max_utf8_size<INENC>(in_bytes.size()) + 3,
+                [in_bytes](char* const buf, const std::size_t) noexcept -> std::size_t
+                   {
+                    std::size_t size = 0;
+                    utxt::bytes_buffer_t<INENC> bytes_buf(in_bytes);
+                    while( bytes_buf.has_codepoint() )
+                       {
+                        size += details::write_utf8(bytes_buf.extract_codepoint(), buf+size);
+                       }
+                    if( bytes_buf.has_bytes() )
+                       {// Truncated codepoint!
+                        size += details::write_utf8(codepoint::invalid, buf+size);
+                       }
+                    return size;
+                   });
+            return out_bytes;
+           }
+       }
+
+    out_bytes.reserve( details::expected_reencoded_size<INENC,OUTENC>(in_bytes.size()) );
+
+    utxt::bytes_buffer_t<INENC> bytes_buf(in_bytes);
+    while( bytes_buf.has_codepoint() )
+       {
+        append_codepoint<OUTENC>(bytes_buf.extract_codepoint(), out_bytes);
+       }
+
+    // Detect truncated
+    if( bytes_buf.has_bytes() )
+       {// Truncated codepoint!
+        append_codepoint<OUTENC>(codepoint::invalid, out_bytes);
+       }
+
+    return out_bytes;
+}
+
+//---------------------------------------------------------------------------
+// Re-encode recording the offsets correspondence in a given map
+// utxt::offset_map_t offsets;
+// const std::string out_bytes = utxt::reencode<UTF16LE,UTF8>(in_bytes, offsets);
+template<utxt::Enc INENC,utxt::Enc OUTENC>
+std::string reencode(const std::string_view in_bytes, offset_map_t& offsets)
+{
+    std::string out_bytes;
+    out_bytes.reserve( details::expected_reencoded_size<INENC,OUTENC>(in_bytes.size()) );
+
+    offsets.clear();
+    std::size_t countdown = offsets.interval();
+    utxt::bytes_buffer_t<INENC> bytes_buf(in_bytes);
+    while( bytes_buf.has_codepoint() )
+       {
+        if( countdown==0 ) [[unlikely]]
+           {
+            countdown = offsets.interval();
+            offsets.add_checkpoint(out_bytes.size(), bytes_buf.byte_pos());
+           }
+        --countdown;
+        append_codepoint<OUTENC>(bytes_buf.extract_codepoint(), out_bytes);
+       }
+
+    // Detect truncated
+    if( bytes_buf.has_bytes() )
+       {// Truncated codepoint!
+        offsets.add_checkpoint(out_bytes.size(), bytes_buf.byte_pos());
+        append_codepoint<OUTENC>(codepoint::invalid, out_bytes);
+       }
+
+    offsets.add_checkpoint(out_bytes.size(), in_bytes.size());
+    return out_bytes;
+}
+
+//---------------------------------------------------------------------------
+// An edit of a byte buffer: the bytes in [offset, offset+removed_size)
+// are replaced by the inserted ones
+struct bytes_edit_t final
+   {
+    std::size_t offset;
+    std::size_t removed_size;
+    std::string_view inserted;
+   };
+
+// The range of the output affected by an edit: the bytes in
+// [offset, offset+removed_size) were replaced by inserted_size bytes
+struct spliced_range_t final
+   {
+    std::size_t offset;
+    std::size_t removed_size;
+    std::size_t inserted_size;
+   };
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace details
+{
+    // Bytes that a decoder may read after the start of a codepoint
+    inline constexpr std::size_t max_lookahead = 3;
+}
+
+//---------------------------------------------------------------------------
+// Apply an edit to the input and re-encode just the codepoints affected,
+// from a checkpoint before the edit until the decoding of the new input
+// resynchronizes with the previous one, splicing the result into the
+// output. The offsets map is the one of the previous re-encoding and
+// is kept updated, so the edits can follow one another
+// utxt::offset_map_t offsets;
+// std::string out_bytes = utxt::reencode<UTF16LE,UTF8>(in_bytes, offsets);
+// const auto changed = utxt::reencode_edit<UTF16LE,UTF8>(in_bytes, out_bytes, offsets, {offset, 2, "\x61\0"sv});
+template<utxt::Enc INENC,utxt::Enc OUTENC>
+spliced_range_t reencode_edit(std::string& in_bytes, std::string& out_bytes, offset_map_t& offsets, const bytes_edit_t& edit)
+{
+    assert( edit.offset+edit.removed_size<=in_bytes.size() );
+
+    // Start from a checkpoint whose preceding codepoints didn't read the edited bytes
+    const offset_map_t::checkpoint_t from = offsets.nearest_by_in(edit.offset>details::max_lookahead ? edit.offset-details::max_lookahead : 0);
+    const std::size_t old_edit_end = edit.offset + edit.removed_size;
+    const std::size_t new_edit_end = edit.offset + edit.inserted.size();
+
+    // The new input around the edit, enough to decode the codepoints that start before its end
+    std::string new_window;
+    new_window.reserve(new_edit_end - from.in_offset + details::max_lookahead);
+    new_window.append(in_bytes, from.in_offset, edit.offset-from.in_offset);
+    new_window.append(edit.inserted);
+    new_window.append(in_bytes, old_edit_end, details::max_lookahead);
+
+    std::string new_out;
+    std::vector<offset_map_t::checkpoint_t> new_checkpoints;
+    std::size_t countdown = offsets.interval();
+    auto append_reencoded = [&](const char32_t codepoint, const std::size_t in_pos)
+       {
+        if( countdown==0 ) [[unlikely]]
+           {
+            countdown = offsets.interval();
+            new_checkpoints.push_back({from.out_offset + new_out.size(), in_pos});
+           }
+        --countdown;
+        append_codepoint<OUTENC>(codepoint, new_out);
+       };
+
+    // Decode the new input until past the edit
+    utxt::bytes_buffer_t<INENC> new_buf(new_window);
+    while( new_buf.byte_pos()<(new_edit_end-from.in_offset) and new_buf.has_bytes() )
+       {
+        const std::size_t in_pos = from.in_offset + new_buf.byte_pos();
+        append_reencoded(details::next_codepoint_of(new_buf), in_pos);
+       }
+
+    // Beyond the edit the new input is the unchanged old one, so continue
+    // there till a codepoint boundary common to the old decoding
+    std::size_t resync_pos = from.in_offset + new_buf.byte_pos() - edit.inserted.size() + edit.removed_size;
+    utxt::bytes_buffer_t<INENC> tail_buf(in_bytes);
+    tail_buf.advance_of(resync_pos);
+    utxt::bytes_buffer_t<INENC> old_buf(in_bytes);
+    old_buf.advance_of(from.in_offset);
+    std::size_t old_out_pos = from.out_offset;
+    while( true )
+       {
+        while( old_buf.byte_pos()<resync_pos )
+           {
+            old_out_pos += encoded_size_of<OUTENC>( details::next_codepoint_of(old_buf) );
+           }
+        if( old_buf.byte_pos()==resync_pos ) break;
+
+        const std::size_t in_pos = tail_buf.byte_pos() + edit.inserted.size() - edit.removed_size;
+        append_reencoded(details::next_codepoint_of(tail_buf), in_pos);
+        resync_pos = tail_buf.byte_pos();
+       }
+
+    // Splice the results
+    const offset_map_t::checkpoint_t old_to{ old_out_pos, resync_pos };
+    const offset_map_t::checkpoint_t new_to{ from.out_offset + new_out.size(), resync_pos + edit.inserted.size() - edit.removed_size };
+    while( not new_checkpoints.empty() and new_checkpoints.back().in_offset>=new_to.in_offset )
+       {
+        new_checkpoints.pop_back();
+       }
+    offsets.splice(from, old_to, new_to, new_checkpoints);
+    in_bytes.replace(edit.offset, edit.removed_size, edit.inserted);
+    out_bytes.replace(from.out_offset, old_out_pos-from.out_offset, new_out);
+
+    return { from.out_offset, old_out_pos-from.out_offset, new_out.size() };
+}
 
 //---------------------------------------------------------------------------
 // const std::string out_bytes = utxt::encode_as<utxt::Enc::UTF8>(in_bytes);
@@ -587,94 +1283,2071 @@ template<utxt::Enc OUTENC>
 //-----------------------------------------------------------------------
 template<utxt::Enc INENC>
 [[nodiscard]] constexpr std::u32string to_utf32(const std::string_view bytes)
+{
+    std::u32string u32str;
+
+    if !consteval
+       {// Write the codepoints straight into a pre-sized output
+        u32str.resize_and_overwrite(bytes.size() + 1,
+            [bytes](char32_t* const buf, const std::size_t) noexcept -> std::size_t
+               {
+                std::size_t size = 0;
+                if constexpr( INENC==utxt::Enc::UTF8 )
+                   {// One attempt per ascii run to store it a word at a time
+                    std::size_t pos = 0;
+                    while( pos<bytes.size() )
+                       {
+                        size += details::store_ascii_run(bytes, pos, buf+size);
+                        while( pos<bytes.size() and (bytes[pos] & 0x80)==0 )
+                           {
+                            buf[size++] = static_cast<char32_t>(bytes[pos++]);
+                           }
+                        while( pos<bytes.size() and (bytes[pos] & 0x80)!=0 )
+                           {
+                            buf[size++] = extract_codepoint<INENC>(bytes, pos);
+                           }
+                       }
+                    return size;
+                   }
+                utxt::bytes_buffer_t<INENC> bytes_buf(bytes);
+                while( bytes_buf.has_codepoint() )
+                   {
+                    buf[size++] = bytes_buf.extract_codepoint();
+                   }
+                if( bytes_buf.has_bytes() )
+                   {// Truncated codepoint!
+                    buf[size++] = codepoint::invalid;
+                   }
+                return size;
+               });
+        return u32str;
+       }
+
+    u32str.reserve( bytes.size() );
+
+    utxt::bytes_buffer_t<INENC> bytes_buf(bytes);
+    while( bytes_buf.has_codepoint() )
+       {
+        u32str.push_back( bytes_buf.extract_codepoint() );
+       }
+
+    // Detect truncated
+    if( bytes_buf.has_bytes() )
+       {// Truncated codepoint!
+        u32str.push_back(codepoint::invalid);
+       }
+
+    return u32str;
+}
+
+//-----------------------------------------------------------------------
+// Decode recording the offsets correspondence in a given map,
+// the output offsets are indexes of the utf-32 string
+template<utxt::Enc INENC>
+[[nodiscard]] std::u32string to_utf32(const std::string_view bytes, offset_map_t& offsets)
 {
     std::u32string u32str;
     u32str.reserve( bytes.size() );
 
+    offsets.clear();
+    std::size_t countdown = offsets.interval();
     utxt::bytes_buffer_t<INENC> bytes_buf(bytes);
     while( bytes_buf.has_codepoint() )
        {
+        if( countdown==0 ) [[unlikely]]
+           {
+            countdown = offsets.interval();
+            offsets.add_checkpoint(u32str.size(), bytes_buf.byte_pos());
+           }
+        --countdown;
         u32str.push_back( bytes_buf.extract_codepoint() );
        }
 
     // Detect truncated
     if( bytes_buf.has_bytes() )
        {// Truncated codepoint!
+        offsets.add_checkpoint(u32str.size(), bytes_buf.byte_pos());
         u32str.push_back(codepoint::invalid);
        }
 
-    return u32str;
-}
+    offsets.add_checkpoint(u32str.size(), bytes.size());
+    return u32str;
+}
+
+[[nodiscard]] /*constexpr*/ std::u32string to_utf32(const std::u8string_view utf8str)
+{
+    return to_utf32<utxt::Enc::UTF8>( std::string_view(reinterpret_cast<const char*>(utf8str.data()), utf8str.size()) );
+}
+
+//-----------------------------------------------------------------------
+// Decode native utf-16 code units
+[[nodiscard]] constexpr std::u32string to_utf32(const std::u16string_view u16str)
+{
+    std::u32string u32str;
+
+    if !consteval
+       {// No more codepoints than units: write in a pre-sized output
+        u32str.resize_and_overwrite(u16str.size(),
+            [u16str](char32_t* const buf, const std::size_t) noexcept -> std::size_t
+               {
+                std::size_t size = 0;
+                std::size_t pos = 0;
+                while( pos<u16str.size() )
+                   {
+                    size += details::store_ascii_run(u16str, pos, buf+size);
+                    if( pos>=u16str.size() ) break;
+                    buf[size++] = extract_codepoint(u16str, pos);
+                   }
+                return size;
+               });
+        return u32str;
+       }
+
+    u32str.reserve( u16str.size() );
+    std::size_t pos = 0;
+    while( pos<u16str.size() )
+       {
+        u32str.push_back( extract_codepoint(u16str, pos) );
+       }
+
+    return u32str;
+}
+
+
+
+/// [Decode bytes to utf-16 string]
+
+//-----------------------------------------------------------------------
+template<utxt::Enc INENC>
+[[nodiscard]] constexpr std::u16string to_utf16(const std::string_view bytes)
+{
+    std::u16string u16str;
+
+    if constexpr( INENC==utxt::Enc::UTF8 )
+       {
+        if !consteval
+           {// No more units than bytes: write in a pre-sized output
+            u16str.resize_and_overwrite(bytes.size(),
+                [bytes](char16_t* const buf, const std::size_t) noexcept -> std::size_t
+                   {
+                    std::size_t size = 0;
+                    utxt::bytes_buffer_t<INENC> bytes_buf(bytes);
+                    while( bytes_buf.has_codepoint() )
+                       {
+                        std::size_t pos = bytes_buf.byte_pos();
+                        size += details::store_ascii_run(bytes, pos, buf+size);
+                        bytes_buf.advance_of(pos - bytes_buf.byte_pos());
+                        if( not bytes_buf.has_codepoint() ) break;
+                        size += details::write_utf16(bytes_buf.extract_codepoint(), buf+size);
+                       }
+                    if( bytes_buf.has_bytes() )
+                       {// Truncated codepoint!
+                        buf[size++] = static_cast<char16_t>(codepoint::invalid);
+                       }
+                    return size;
+                   });
+            return u16str;
+           }
+       }
+
+    u16str.reserve( INENC==utxt::Enc::UTF8 ? bytes.size() : bytes.size()/2 );
+
+    utxt::bytes_buffer_t<INENC> bytes_buf(bytes);
+    while( bytes_buf.has_codepoint() )
+       {
+        append_codepoint(bytes_buf.extract_codepoint(), u16str);
+       }
+
+    // Detect truncated
+    if( bytes_buf.has_bytes() )
+       {// Truncated codepoint!
+        append_codepoint(codepoint::invalid, u16str);
+       }
+
+    return u16str;
+}
+
+[[nodiscard]] inline /*constexpr*/ std::u16string to_utf16(const std::u8string_view utf8str)
+{
+    return to_utf16<utxt::Enc::UTF8>( std::string_view(reinterpret_cast<const char*>(utf8str.data()), utf8str.size()) );
+}
+
+//-----------------------------------------------------------------------
+[[nodiscard]] constexpr std::u16string to_utf16(const std::u32string_view u32str)
+{
+    std::u16string u16str;
+    u16str.reserve( u32str.size() );
+
+    for( const char32_t codepoint : u32str )
+       {
+        append_codepoint(codepoint, u16str);
+       }
+
+    return u16str;
+}
+
+
+
+/// [Encode utf-32 to bytes]
+
+//---------------------------------------------------------------------------
+// Encode a char32_t sequence to OUTENC
+// const std::string out_bytes = utxt::encode_as<UTF16LE>(U"abc");
+//-----------------------------------------------------------------------
+template<utxt::Enc OUTENC>
+[[nodiscard]] constexpr std::string encode_as(const std::u32string_view u32str)
+{
+    std::string out_bytes;
+
+    if constexpr( OUTENC==Enc::UTF8 )
+       {
+        if !consteval
+           {// Write the sequences straight into a pre-sized output
+            out_bytes.resize_and_overwrite(4 * u32str.size() + 3,
+                [u32str](char* const buf, const std::size_t) noexcept -> std::size_t
+                   {
+                    std::size_t size = 0;
+                    for( const char32_t codepoint : u32str )
+                       {
+                        size += details::write_utf8(codepoint, buf+size);
+                       }
+                    return size;
+                   });
+            return out_bytes;
+           }
+       }
+
+    // Assuming the worst case: four bytes per codepoint
+    out_bytes.reserve( 4 * u32str.size() );
+
+    for( const char32_t codepoint : u32str )
+       {
+        append_codepoint<OUTENC>(codepoint, out_bytes);
+       }
+
+    return out_bytes;
+}
+
+//-----------------------------------------------------------------------
+// Encode native utf-16 code units to OUTENC
+// const std::string out_bytes = utxt::encode_as<UTF8>(u"abc");
+template<utxt::Enc OUTENC>
+[[nodiscard]] constexpr std::string encode_as(const std::u16string_view u16str)
+{
+    std::string out_bytes;
+    using enum utxt::Enc;
+
+    if !consteval
+       {
+        if constexpr( OUTENC==UTF16LE or OUTENC==UTF16BE )
+           {// Same units: a plain copy, then the unpaired surrogates are replaced
+            out_bytes.resize_and_overwrite(2 * u16str.size(),
+                [u16str](char* const buf, const std::size_t size) noexcept -> std::size_t
+                   {
+                    constexpr bool same_endianness = (OUTENC==UTF16LE) == (std::endian::native==std::endian::little);
+                    std::memcpy(buf, u16str.data(), size);
+                    if constexpr( not same_endianness )
+                       {
+                        for( std::size_t i=0; i<size; i+=2 )
+                           {
+                            std::swap(buf[i], buf[i+1]);
+                           }
+                       }
+                    std::size_t pos = 0;
+                    while( pos<u16str.size() )
+                       {
+                        if( u16str[pos]<0xD800 or u16str[pos]>=0xE000 ) [[likely]]
+                           {
+                            ++pos;
+                           }
+                        else
+                           {
+                            const std::size_t unit_pos = pos;
+                            if( extract_codepoint(u16str, pos)==codepoint::invalid )
+                               {
+                                encode_to<OUTENC>(codepoint::invalid, buf + 2*unit_pos);
+                               }
+                           }
+                       }
+                    return size;
+                   });
+            return out_bytes;
+           }
+        else if constexpr( OUTENC==UTF8 )
+           {// At most three bytes per unit, plus the room of a whole write
+            out_bytes.resize_and_overwrite(3 * u16str.size() + 3,
+                [u16str](char* const buf, const std::size_t) noexcept -> std::size_t
+                   {
+                    std::size_t size = 0;
+                    std::size_t pos = 0;
+                    while( pos<u16str.size() )
+                       {
+                        size += details::store_ascii_run(u16str, pos, buf+size);
+                        if( pos>=u16str.size() ) break;
+                        size += details::write_utf8(extract_codepoint(u16str, pos), buf+size);
+                       }
+                    return size;
+                   });
+            return out_bytes;
+           }
+        else
+           {// At most four bytes per unit
+            out_bytes.resize_and_overwrite(4 * u16str.size(),
+                [u16str](char* const buf, const std::size_t) noexcept -> std::size_t
+                   {
+                    constexpr bool same_endianness = (OUTENC==UTF32LE) == (std::endian::native==std::endian::little);
+                    std::size_t size = 0;
+                    std::size_t pos = 0;
+                    while( pos<u16str.size() )
+                       {
+                        std::uint32_t codepoint = extract_codepoint(u16str, pos);
+                        if constexpr( not same_endianness )
+                           {
+                            codepoint = std::byteswap(codepoint);
+                           }
+                        std::memcpy(buf+size, &codepoint, sizeof(codepoint));
+                        size += sizeof(codepoint);
+                       }
+                    return size;
+                   });
+            return out_bytes;
+           }
+       }
+
+    // Assuming the worst case: four bytes per unit for utf-32, three for utf-8
+    out_bytes.reserve( (OUTENC==UTF32LE or OUTENC==UTF32BE ? 4 : 3) * u16str.size() );
+
+    std::size_t pos = 0;
+    while( pos<u16str.size() )
+       {
+        append_codepoint<OUTENC>(extract_codepoint(u16str, pos), out_bytes);
+       }
+
+    return out_bytes;
+}
+
+//-----------------------------------------------------------------------
+template<utxt::Enc OUTENC>
+[[nodiscard]] constexpr std::string encode_as(const char32_t codepoint)
+{
+    std::string out_bytes;
+    out_bytes.reserve( 4 );
+    append_codepoint<OUTENC>(codepoint, out_bytes);
+    return out_bytes;
+}
+
+//---------------------------------------------------------------------------
+// const std::string out_bytes = utxt::encode_as(enc,U"str");
+//template<typename T>
+//concept a_basic_string = std::same_as<T, std::basic_string<typename T::value_type, typename T::traits_type, typename T::allocator_type>>;
+[[nodiscard]] constexpr std::string encode_as(const utxt::Enc enc, const std::u32string_view u32str)
+{
+    TEXT_DISPATCH_TO_ENC(enc, encode_as<, >(u32str))
+}
+//---------------------------------------------------------------------------
+[[nodiscard]] constexpr std::string encode_as(const utxt::Enc enc, const char32_t codepoint)
+{
+    TEXT_DISPATCH_TO_ENC(enc, encode_as<, >(codepoint))
+}
+//---------------------------------------------------------------------------
+[[nodiscard]] constexpr std::string encode_as(const utxt::Enc enc, const std::u16string_view u16str)
+{
+    TEXT_DISPATCH_TO_ENC(enc, encode_as<, >(u16str))
+}
+
+
+
+/// [Encode utf-32 to utf-8 bytes]
+
+//-----------------------------------------------------------------------
+[[nodiscard]] constexpr std::string to_utf8(const std::u32string_view u32str)
+{
+    return encode_as<Enc::UTF8>(u32str);
+}
+//-----------------------------------------------------------------------
+[[nodiscard]] constexpr std::string to_utf8(const char32_t codepoint)
+{
+    return encode_as<Enc::UTF8>(codepoint);
+}
+//-----------------------------------------------------------------------
+[[nodiscard]] constexpr std::string to_utf8(const std::u16string_view u16str)
+{
+    return encode_as<Enc::UTF8>(u16str);
+}
+
+
+
+
+/// [Encode to an output iterator]
+
+//---------------------------------------------------------------------------
+// Re-encode a byte buffer from INENC to OUTENC into an output iterator
+// utxt::reencode_to<UTF16LE,UTF8>(in_bytes, std::back_inserter(out_bytes));
+template<utxt::Enc INENC, utxt::Enc OUTENC, std::output_iterator<char> OutputIt>
+constexpr OutputIt reencode_to(const std::string_view in_bytes, OutputIt out)
+{
+    utxt::bytes_buffer_t<INENC> bytes_buf(in_bytes);
+    while( bytes_buf.has_codepoint() )
+       {
+        out = encode_to<OUTENC>(bytes_buf.extract_codepoint(), out);
+       }
+
+    // Detect truncated
+    if( bytes_buf.has_bytes() )
+       {// Truncated codepoint!
+        out = encode_to<OUTENC>(codepoint::invalid, out);
+       }
+
+    return out;
+}
+
+//---------------------------------------------------------------------------
+// utxt::encode_to<UTF8>(utxt::encoded_view_t{in_bytes, in_enc}, out);
+template<utxt::Enc OUTENC, std::output_iterator<char> OutputIt>
+constexpr OutputIt encode_to(const encoded_view_t txt, OutputIt out)
+{
+    TEXT_DISPATCH_TO_ENC(txt.enc, reencode_to<, ,OUTENC>(txt.bytes, out))
+}
+
+//---------------------------------------------------------------------------
+// utxt::encode_to<UTF8>(U"abc"sv, std::back_inserter(out_bytes));
+template<utxt::Enc OUTENC, std::output_iterator<char> OutputIt>
+constexpr OutputIt encode_to(const std::u32string_view u32str, OutputIt out)
+{
+    for( const char32_t codepoint : u32str )
+       {
+        out = encode_to<OUTENC>(codepoint, out);
+       }
+    return out;
+}
+
+//---------------------------------------------------------------------------
+// utxt::encode_to<UTF8>(u"abc"sv, std::back_inserter(out_bytes));
+template<utxt::Enc OUTENC, std::output_iterator<char> OutputIt>
+constexpr OutputIt encode_to(const std::u16string_view u16str, OutputIt out)
+{
+    std::size_t pos = 0;
+    while( pos<u16str.size() )
+       {
+        out = encode_to<OUTENC>(extract_codepoint(u16str, pos), out);
+       }
+    return out;
+}
+
+
+
+/// [Write text as utf-8 to std::format and streams]
+
+//---------------------------------------------------------------------------
+// std::format("{}", utxt::as<UTF16LE>(in_bytes));
+template<utxt::Enc INENC>
+[[nodiscard]] constexpr encoded_view_t as(const std::string_view bytes) noexcept
+{
+    return {bytes, INENC};
+}
+
+//---------------------------------------------------------------------------
+// std::format("{}", utxt::as_utf8(U"abc"sv));
+template<typename CharT> struct as_utf8_t final
+   {
+    std::basic_string_view<CharT> str;
+   };
+[[nodiscard]] constexpr as_utf8_t<char32_t> as_utf8(const std::u32string_view u32str) noexcept
+{
+    return {u32str};
+}
+[[nodiscard]] constexpr as_utf8_t<char16_t> as_utf8(const std::u16string_view u16str) noexcept
+{
+    return {u16str};
+}
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace details
+{
+    //-----------------------------------------------------------------------
+    // Bytes already encoded as utf-8 are written as they are
+    template<std::output_iterator<char> OutputIt>
+    constexpr OutputIt write_as_utf8(const encoded_view_t txt, OutputIt out)
+       {
+        if( txt.enc==Enc::UTF8 )
+           {
+            return std::copy(txt.bytes.begin(), txt.bytes.end(), out);
+           }
+        return encode_to<Enc::UTF8>(txt, out);
+       }
+
+    //-----------------------------------------------------------------------
+    template<typename CharT, std::output_iterator<char> OutputIt>
+    constexpr OutputIt write_as_utf8(const as_utf8_t<CharT> txt, OutputIt out)
+       {
+        return encode_to<Enc::UTF8>(txt.str, out);
+       }
+
+    //-----------------------------------------------------------------------
+    template<typename T, typename Traits>
+    std::basic_ostream<char,Traits>& write_as_utf8(std::basic_ostream<char,Traits>& os, const T& txt)
+       {
+        if( const typename std::basic_ostream<char,Traits>::sentry sentry(os); sentry )
+           {
+            if( write_as_utf8(txt, std::ostreambuf_iterator<char,Traits>(os)).failed() )
+               {
+                os.setstate(std::ios_base::badbit);
+               }
+           }
+        return os;
+       }
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
+
+//---------------------------------------------------------------------------
+// std::cout << utxt::as<UTF16LE>(in_bytes);
+template<typename Traits>
+std::basic_ostream<char,Traits>& operator<<(std::basic_ostream<char,Traits>& os, const encoded_view_t txt)
+{
+    return details::write_as_utf8(os, txt);
+}
+
+//---------------------------------------------------------------------------
+// std::cout << utxt::as_utf8(U"abc"sv);
+template<typename CharT, typename Traits>
+std::basic_ostream<char,Traits>& operator<<(std::basic_ostream<char,Traits>& os, const as_utf8_t<CharT> txt)
+{
+    return details::write_as_utf8(os, txt);
+}
+
+
+
+
+//---------------------------------------------------------------------------
+struct text_position_t final
+   {
+    std::size_t line;
+    std::size_t column;
+   };
+
+/////////////////////////////////////////////////////////////////////////////
+// Line start offsets of a byte buffer, to map byte offsets to
+// (line, column) positions and back. Lines and columns are 1-based,
+// columns are counted in codepoints
+// utxt::line_index_t<UTF16LE> lines(bytes);
+// const auto [line, column] = lines.position_of(byte_offset);
+template<Enc ENC> class line_index_t final
+{
+ private:
+    static constexpr std::size_t unit_size = code_unit_size_of(ENC);
+    // Offset of the significant byte inside a code unit
+    static constexpr std::size_t low_byte_offset = (ENC==Enc::UTF16BE or ENC==Enc::UTF32BE) ? unit_size-1 : 0;
+
+    std::string_view m_byte_buf;
+    std::vector<std::size_t> m_line_starts; // Byte offsets of lines first code unit
+
+ public:
+    explicit line_index_t(const std::string_view bytes)
+      : m_byte_buf{bytes}
+       {
+        m_line_starts.push_back(0);
+
+        // Let memchr do the vectorized search of the line feed byte,
+        // then check if that's actually a line feed code unit
+        const char* const begin = m_byte_buf.data();
+        const char* const end = begin + m_byte_buf.size();
+        const char* p = begin;
+        while( p<end )
+           {
+            const char* const lf = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end-p)));
+            if( not lf ) break;
+            p = lf + 1;
+
+            const std::size_t lf_offset = static_cast<std::size_t>(lf-begin);
+            if constexpr( unit_size>1 )
+               {
+                if( (lf_offset % unit_size)!=low_byte_offset ) continue;
+                const std::size_t unit_start = lf_offset - low_byte_offset;
+                if( (unit_start+unit_size)>m_byte_buf.size() ) break;
+                if( not is_line_feed_unit_at(unit_start) ) continue;
+                p = begin + unit_start + unit_size;
+               }
+            m_line_starts.push_back( static_cast<std::size_t>(p-begin) );
+           }
+       }
+
+    [[nodiscard]] std::size_t lines_count() const noexcept
+       {
+        return m_line_starts.size();
+       }
+
+    //-----------------------------------------------------------------------
+    // The content of a line, without the line terminator (\n or \r\n)
+    [[nodiscard]] std::string_view line(const std::size_t line) const noexcept
+       {
+        assert( line>0 and line<=lines_count() );
+        const std::size_t start = m_line_starts[line-1];
+        std::size_t end = m_byte_buf.size();
+        if( line<lines_count() )
+           {
+            end = m_line_starts[line] - unit_size;
+            if( end>=(start+unit_size) and is_carriage_return_unit_at(end-unit_size) )
+               {
+                end -= unit_size;
+               }
+           }
+        return m_byte_buf.substr(start, end-start);
+       }
+
+    //-----------------------------------------------------------------------
+    // A byte offset in the middle of a codepoint refers to that codepoint,
+    // as one in a \r\n terminator refers to the start of the terminator
+    [[nodiscard]] text_position_t position_of(const std::size_t byte_offset) const noexcept
+       {
+        assert( byte_offset<=m_byte_buf.size() );
+        const auto it = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), byte_offset);
+        const std::size_t line_num = static_cast<std::size_t>(it - m_line_starts.begin());
+        const std::size_t start = m_line_starts[line_num-1];
+
+        // Count the codepoints that end before the offset
+        const std::size_t rel_offset = std::min(byte_offset - start, line(line_num).size());
+        utxt::bytes_buffer_t<ENC> bytes_buf(m_byte_buf.substr(start));
+        std::size_t column = 1;
+        while( bytes_buf.byte_pos()<rel_offset and bytes_buf.has_codepoint() )
+           {
+            [[maybe_unused]] const char32_t codepoint = bytes_buf.extract_codepoint();
+            if( bytes_buf.byte_pos()>rel_offset ) break; // The offset falls inside this codepoint
+            ++column;
+           }
+        return { line_num, column };
+       }
+
+    //-----------------------------------------------------------------------
+    // Positions beyond the end of a line are clamped to the line end
+    [[nodiscard]] std::size_t byte_offset_of(const text_position_t pos) const noexcept
+       {
+        assert( pos.line>0 and pos.column>0 );
+        if( pos.line>lines_count() ) return m_byte_buf.size();
+
+        const std::string_view line_bytes = line(pos.line);
+        utxt::bytes_buffer_t<ENC> bytes_buf(line_bytes);
+        for( std::size_t column=1; column<pos.column and bytes_buf.has_codepoint(); ++column )
+           {
+            [[maybe_unused]] const char32_t codepoint = bytes_buf.extract_codepoint();
+           }
+        return m_line_starts[pos.line-1] + std::min(bytes_buf.byte_pos(), line_bytes.size());
+       }
+
+ private:
+    [[nodiscard]] bool is_unit_at(const std::size_t unit_start, const char ch) const noexcept
+       {
+        for( std::size_t i=0; i<unit_size; ++i )
+           {
+            if( m_byte_buf[unit_start+i] != (i==low_byte_offset ? ch : '\0') ) return false;
+           }
+        return true;
+       }
+    [[nodiscard]] bool is_line_feed_unit_at(const std::size_t unit_start) const noexcept { return is_unit_at(unit_start, '\n'); }
+    [[nodiscard]] bool is_carriage_return_unit_at(const std::size_t unit_start) const noexcept { return is_unit_at(unit_start, '\r'); }
+};
+
+
+
+/// [Hash and compare text of any encoding]
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace details
+{
+    //-----------------------------------------------------------------------
+    // Full 64x64 bit product folded to 64 bits, the wyhash mixing primitive
+    [[nodiscard]] constexpr std::uint64_t mum(const std::uint64_t a, const std::uint64_t b) noexcept
+       {
+      #if defined(__SIZEOF_INT128__)
+        __extension__ using uint128_t = unsigned __int128;
+        const uint128_t r = static_cast<uint128_t>(a) * b;
+        return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+      #else
+        const std::uint64_t a_lo = a & 0xFFFF'FFFF, a_hi = a >> 32;
+        const std::uint64_t b_lo = b & 0xFFFF'FFFF, b_hi = b >> 32;
+        const std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+        const std::uint64_t mid = (ll >> 32) + (lh & 0xFFFF'FFFF) + (hl & 0xFFFF'FFFF);
+        const std::uint64_t lo = (ll & 0xFFFF'FFFF) | (mid << 32);
+        const std::uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        return lo ^ hi;
+      #endif
+       }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Hashes a stream of bytes in 64 bit words,
+    // the result doesn't depend on how the bytes are fed
+    class bytes_hasher_t final
+    {
+     private:
+        static constexpr std::uint64_t secret0 = 0xA076'1D64'78BD'642F;
+        static constexpr std::uint64_t secret1 = 0xE703'7ED1'A0B4'28DB;
+        static constexpr std::uint64_t secret2 = 0x8EBC'6AF0'9C88'C6E3;
+        static constexpr std::uint64_t secret3 = 0x5899'65CC'7537'4CC3;
+
+        std::uint64_t m_state = secret0;
+        std::uint64_t m_word = 0; // Pending bytes, little endian
+        std::uint64_t m_size = 0; // Bytes fed so far
+
+     public:
+        constexpr void feed(const char ch) noexcept
+           {
+            m_word |= static_cast<std::uint64_t>(static_cast<unsigned char>(ch)) << (8 * (m_size % 8));
+            if( (++m_size % 8)==0 )
+               {
+                mix(m_word);
+                m_word = 0;
+               }
+           }
+
+        constexpr void feed(const std::string_view bytes) noexcept
+           {
+            std::size_t i = 0;
+            if !consteval
+               {
+                if( (m_size % 8)==0 )
+                   {// Aligned to word boundary, can feed whole words
+                    for( ; (i+8)<=bytes.size(); i+=8 )
+                       {
+                        std::uint64_t word = load_word(bytes.data()+i);
+                        if constexpr( std::endian::native==std::endian::big )
+                           {
+                            word = std::byteswap(word);
+                           }
+                        mix(word);
+                       }
+                    m_size += i;
+                   }
+               }
+            for( ; i<bytes.size(); ++i )
+               {
+                feed(bytes[i]);
+               }
+           }
+
+        [[nodiscard]] constexpr std::uint64_t digest() const noexcept
+           {
+            return mum(mum(m_state ^ secret1, m_word ^ secret2), m_size ^ secret3);
+           }
+
+     private:
+        constexpr void mix(const std::uint64_t word) noexcept
+           {
+            m_state = mum(word ^ secret1, m_state ^ secret2);
+           }
+    };
+
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
+
+//---------------------------------------------------------------------------
+// Hash of the decoded codepoints sequence, the same text has the same
+// hash in any encoding. Defined as the hash of its utf-8 encoding, so the
+// valid utf-8 runs are hashed directly, the invalid sequences as '\uFFFD'
+// const std::uint64_t h = utxt::hash<UTF16LE>(in_bytes);
+template<utxt::Enc INENC>
+[[nodiscard]] constexpr std::uint64_t hash(const std::string_view bytes) noexcept
+{
+    details::bytes_hasher_t hasher;
+    if constexpr( INENC==Enc::UTF8 )
+       {
+        std::size_t run_start = 0; // Valid bytes not yet fed
+        std::size_t pos = 0;
+        while( pos<bytes.size() )
+           {
+            if !consteval
+               {// Skip the ascii words
+                while( (pos+8)<=bytes.size() and details::are_all_ascii_bytes(details::load_word(bytes.data()+pos)) )
+                   {
+                    pos += 8;
+                   }
+                if( pos>=bytes.size() ) break;
+               }
+            if( (bytes[pos] & 0x80)==0 )
+               {
+                ++pos;
+               }
+            else if( const std::size_t seq_size = details::valid_utf8_seq_size(bytes, pos); seq_size>0 ) [[likely]]
+               {
+                pos += seq_size;
+               }
+            else
+               {// Invalid sequence: skipped as the decoder does
+                hasher.feed(bytes.substr(run_start, pos-run_start));
+                hasher.feed("\xEF\xBF\xBD"); // '\uFFFD'
+                utxt::bytes_buffer_t<INENC> bytes_buf(bytes);
+                bytes_buf.advance_of(pos);
+                [[maybe_unused]] const char32_t invalid = details::next_codepoint_of(bytes_buf);
+                pos = run_start = bytes_buf.byte_pos();
+               }
+           }
+        hasher.feed(bytes.substr(run_start));
+       }
+    else
+       {
+        std::string utf8_bytes; // Stays in the small buffer
+        utxt::bytes_buffer_t<INENC> bytes_buf(bytes);
+        char32_t codepoint;
+        while( (codepoint = details::next_codepoint_of(bytes_buf))!=details::end_of_text )
+           {
+            if( codepoint<0x80 ) [[likely]]
+               {
+                hasher.feed( static_cast<char>(codepoint) );
+               }
+            else
+               {
+                utf8_bytes.clear();
+                append_codepoint<Enc::UTF8>(codepoint, utf8_bytes);
+                hasher.feed(utf8_bytes);
+               }
+           }
+       }
+    return hasher.digest();
+}
+
+//---------------------------------------------------------------------------
+[[nodiscard]] constexpr std::uint64_t hash(const encoded_view_t txt) noexcept
+{
+    TEXT_DISPATCH_TO_ENC(txt.enc, hash<, >(txt.bytes))
+}
+
+//---------------------------------------------------------------------------
+// Compare the decoded codepoints sequences of two byte buffers without
+// decoding them to a buffer: like the hash, the invalid sequences are
+// equivalent to '\uFFFD', so different bytes may be the same text
+// const bool same = utxt::equal<UTF16LE,UTF8>(bytes1, bytes2);
+template<utxt::Enc ENC_A, utxt::Enc ENC_B>
+[[nodiscard]] constexpr bool equal(std::string_view a, std::string_view b) noexcept
+{
+    if constexpr( ENC_A==ENC_B )
+       {
+        if( a==b )
+           {// Same bytes, same codepoints
+            return true;
+           }
+        if constexpr( ENC_A==Enc::UTF8 )
+           {// Skip the common prefix up to its last ascii character
+            const std::size_t mismatch_pos = static_cast<std::size_t>(std::ranges::mismatch(a, b).in1 - a.begin());
+            if( mismatch_pos>=a.size() or mismatch_pos>=b.size() or
+                (a[mismatch_pos] & 0x80)==0 or (b[mismatch_pos] & 0x80)==0 )
+               {// At a codepoint boundary, an ascii character differs from anything else
+                if( mismatch_pos==0 or (a[mismatch_pos-1] & 0x80)==0 ) return false;
+               }
+            std::size_t common_size = mismatch_pos;
+            while( common_size>0 and (a[common_size-1] & 0x80)!=0 )
+               {
+                --common_size;
+               }
+            a.remove_prefix(common_size);
+            b.remove_prefix(common_size);
+           }
+       }
+
+    utxt::bytes_buffer_t<ENC_A> bytes_buf_a(a);
+    utxt::bytes_buffer_t<ENC_B> bytes_buf_b(b);
+    while( true )
+       {
+        const char32_t codepoint = details::next_codepoint_of(bytes_buf_a);
+        if( codepoint!=details::next_codepoint_of(bytes_buf_b) ) return false;
+        if( codepoint==details::end_of_text ) return true;
+       }
+}
+
+//---------------------------------------------------------------------------
+namespace details
+{
+    template<utxt::Enc ENC_A>
+    [[nodiscard]] constexpr bool equal_to(const std::string_view a, const encoded_view_t b) noexcept
+       {
+        TEXT_DISPATCH_TO_ENC(b.enc, equal<, ,ENC_A>(b.bytes, a))
+       }
+}
+[[nodiscard]] constexpr bool equal(const encoded_view_t a, const encoded_view_t b) noexcept
+{
+    TEXT_DISPATCH_TO_ENC(a.enc, details::equal_to<, >(a.bytes, b))
+}
+
+//---------------------------------------------------------------------------
+// Transparent functors for hash containers keyed by utf-8 strings
+// std::unordered_map<std::string,int,utxt::text_hash_t,utxt::text_equal_t> map;
+// auto it = map.find(utxt::encoded_view_t{utf16le_bytes, UTF16LE});
+struct text_hash_t final
+{
+    using is_transparent = void;
+    [[nodiscard]] constexpr std::size_t operator()(const std::string_view utf8_bytes) const noexcept
+       {
+        return static_cast<std::size_t>(hash<Enc::UTF8>(utf8_bytes));
+       }
+    [[nodiscard]] constexpr std::size_t operator()(const encoded_view_t txt) const noexcept
+       {
+        return static_cast<std::size_t>(hash(txt));
+       }
+};
+//---------------------------------------------------------------------------
+struct text_equal_t final
+{
+    using is_transparent = void;
+    [[nodiscard]] constexpr bool operator()(const std::string_view a, const std::string_view b) const noexcept
+       {
+        return equal<Enc::UTF8,Enc::UTF8>(a, b);
+       }
+    [[nodiscard]] constexpr bool operator()(const std::string_view a, const encoded_view_t b) const noexcept
+       {
+        return equal({a, Enc::UTF8}, b);
+       }
+    [[nodiscard]] constexpr bool operator()(const encoded_view_t a, const std::string_view b) const noexcept
+       {
+        return equal(a, {b, Enc::UTF8});
+       }
+    [[nodiscard]] constexpr bool operator()(const encoded_view_t a, const encoded_view_t b) const noexcept
+       {
+        return equal(a, b);
+       }
+};
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Text bytes with their detected encoding, other encodings are
+// produced on first request and then cached. Concurrent readers
+// are safe, each encoding is initialized just once
+// const utxt::text_t txt(std::move(bytes), utxt::flag::SKIP_BOM);
+// const std::string_view utf8_bytes = txt.as<UTF8>();
+class text_t final
+{
+ private:
+    static constexpr std::size_t encodings_count = 5;
+
+    struct encoded_cache_t final
+       {
+        std::array<std::once_flag,encodings_count> once_encoded;
+        std::array<std::string,encodings_count> encoded;
+       };
+
+    std::string m_bytes;
+    std::size_t m_content_offset = 0; // To skip the byte order mask
+    Enc m_enc;
+    std::unique_ptr<encoded_cache_t> m_cache = std::make_unique<encoded_cache_t>(); // Null if moved from
+
+ public:
+    //-----------------------------------------------------------------------
+    // Detecting the encoding from the byte order mask
+    explicit text_t(std::string bytes, const flags_t flags =flag::NONE)
+      : m_bytes{std::move(bytes)}
+       {
+        const auto [enc, bom_size] = detect_encoding_of(m_bytes);
+        m_enc = enc;
+        if( flags & flag::SKIP_BOM )
+           {
+            m_content_offset = bom_size;
+           }
+       }
+
+    //-----------------------------------------------------------------------
+    // Bytes of known encoding
+    text_t(std::string bytes, const Enc enc)
+      : m_bytes{std::move(bytes)}
+      , m_enc{enc}
+       {}
+
+    // Copies start with an empty cache, moves take it along
+    // with the bytes and leave an empty text without cache
+    text_t(const text_t& other)
+      : m_bytes{other.m_bytes}
+      , m_content_offset{other.m_content_offset}
+      , m_enc{other.m_enc}
+       {}
+    text_t(text_t&& other) noexcept
+      : m_bytes{std::move(other.m_bytes)}
+      , m_content_offset{other.m_content_offset}
+      , m_enc{other.m_enc}
+      , m_cache{std::move(other.m_cache)}
+       {
+        other.set_as_moved_from();
+       }
+    text_t& operator=(const text_t& other)
+       {
+        if( this!=&other )
+           {
+            m_bytes = other.m_bytes;
+            m_content_offset = other.m_content_offset;
+            m_enc = other.m_enc;
+            m_cache = std::make_unique<encoded_cache_t>();
+           }
+        return *this;
+       }
+    text_t& operator=(text_t&& other) noexcept
+       {
+        if( this!=&other )
+           {
+            m_bytes = std::move(other.m_bytes);
+            m_content_offset = other.m_content_offset;
+            m_enc = other.m_enc;
+            m_cache = std::move(other.m_cache);
+            other.set_as_moved_from();
+           }
+        return *this;
+       }
+    ~text_t() = default;
+
+    [[nodiscard]] Enc enc() const noexcept { return m_enc; }
+
+    //-----------------------------------------------------------------------
+    // The original bytes (without the byte order mask if skipped)
+    [[nodiscard]] std::string_view bytes() const noexcept
+       {
+        return std::string_view(m_bytes).substr(m_content_offset);
+       }
+
+    //-----------------------------------------------------------------------
+    // The bytes encoded as OUTENC, no copies if already encoded as such
+    template<utxt::Enc OUTENC>
+    [[nodiscard]] std::string_view as() const
+       {
+        if( OUTENC==m_enc or not m_cache )
+           {// Same encoding, or moved from (no bytes)
+            return bytes();
+           }
+
+        constexpr std::size_t idx = static_cast<std::size_t>(OUTENC);
+        std::call_once(m_cache->once_encoded[idx], [this]() -> void
+           {
+            m_cache->encoded[idx] = [this]() -> std::string
+               {
+                TEXT_DISPATCH_TO_ENC(m_enc, reencode<, ,OUTENC>(bytes()))
+               }();
+           });
+        return m_cache->encoded[idx];
+       }
+
+    //-----------------------------------------------------------------------
+    [[nodiscard]] std::string_view as(const utxt::Enc out_enc) const
+       {
+        TEXT_DISPATCH_TO_ENC(out_enc, as<, >())
+       }
+
+ private:
+    void set_as_moved_from() noexcept
+       {
+        m_bytes.clear();
+        m_content_offset = 0;
+        m_cache.reset();
+       }
+};
+
+
+
+/////////////////////////////////////////////////////////////////////////////
+// A stream buffer that transcodes the content of an underlying one,
+// to replace the deprecated std::codecvt: the INENC bytes read from the
+// device are presented as OUTENC, the OUTENC bytes written are sent as
+// INENC. Converts a block at a time, carrying the partial codepoints
+// std::ifstream file("in.txt", std::ios::binary);
+// utxt::transcoding_streambuf_t<UTF16LE,UTF8> buf(*file.rdbuf(), utxt::flag::SKIP_BOM);
+// std::istream is(&buf);
+// while( std::getline(is, line) ) ...
+template<Enc INENC, Enc OUTENC>
+class transcoding_streambuf_t final : public std::streambuf
+{
+ private:
+    std::streambuf& m_device;
+    const std::size_t m_block_size;
+    bool m_bom_to_check;
+    std::string m_in_bytes; // Read from device, not yet decoded
+    std::string m_get_bytes; // Get area
+    std::string m_put_bytes; // Put area
+    std::string m_out_bytes; // Written bytes, not yet encoded
+
+ public:
+    explicit transcoding_streambuf_t(std::streambuf& device, const flags_t flags =flag::NONE, const std::size_t block_size =0x10000)
+      : m_device{device}
+      , m_block_size{block_size>0 ? block_size : 1}
+      , m_bom_to_check{(flags & flag::SKIP_BOM)!=0}
+       {
+        m_put_bytes.resize(m_block_size);
+        setp(m_put_bytes.data(), m_put_bytes.data()+m_put_bytes.size());
+       }
+
+    ~transcoding_streambuf_t() override
+       {
+        try{ [[maybe_unused]] const bool flushed = flush_put_area(true); }
+        catch(...) {}
+       }
+
+    transcoding_streambuf_t(const transcoding_streambuf_t&) = delete;
+    transcoding_streambuf_t& operator=(const transcoding_streambuf_t&) = delete;
+
+ protected:
+    //-----------------------------------------------------------------------
+    int_type underflow() override
+       {
+        if( gptr()<egptr() )
+           {
+            return traits_type::to_int_type(*gptr());
+           }
+
+        m_get_bytes.clear();
+        while( m_get_bytes.empty() )
+           {
+            const bool at_eof = not read_block();
+            if( m_bom_to_check and (at_eof or m_in_bytes.size()>=4) )
+               {
+                skip_bom();
+               }
+            if( at_eof )
+               {// Decode everything, truncated codepoint included
+                reencode_to<INENC,OUTENC>(m_in_bytes, std::back_inserter(m_get_bytes));
+                m_in_bytes.clear();
+                break;
+               }
+            else if( not m_bom_to_check )
+               {// Decode the complete codepoints
+                const std::size_t complete_size = m_in_bytes.size() - details::incomplete_tail_size<INENC>(m_in_bytes);
+                reencode_to<INENC,OUTENC>(std::string_view(m_in_bytes).substr(0,complete_size), std::back_inserter(m_get_bytes));
+                m_in_bytes.erase(0, complete_size);
+               }
+           }
+
+        if( m_get_bytes.empty() )
+           {
+            return traits_type::eof();
+           }
+        setg(m_get_bytes.data(), m_get_bytes.data(), m_get_bytes.data()+m_get_bytes.size());
+        return traits_type::to_int_type(*gptr());
+       }
+
+    //-----------------------------------------------------------------------
+    int_type overflow(const int_type ch) override
+       {
+        if( not flush_put_area(false) )
+           {
+            return traits_type::eof();
+           }
+        if( not traits_type::eq_int_type(ch, traits_type::eof()) )
+           {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+           }
+        return traits_type::not_eof(ch);
+       }
+
+    //-----------------------------------------------------------------------
+    int sync() override
+       {
+        if( not flush_put_area(false) )
+           {
+            return -1;
+           }
+        return m_device.pubsync();
+       }
+
+ private:
+    //-----------------------------------------------------------------------
+    // Append a block read from the device, false if nothing was read
+    [[nodiscard]] bool read_block()
+       {
+        const std::size_t prev_size = m_in_bytes.size();
+        m_in_bytes.resize(prev_size + m_block_size);
+        const std::streamsize n = m_device.sgetn(m_in_bytes.data()+prev_size, static_cast<std::streamsize>(m_block_size));
+        m_in_bytes.resize(prev_size + static_cast<std::size_t>(n>0 ? n : 0));
+        return n>0;
+       }
+
+    //-----------------------------------------------------------------------
+    void skip_bom() noexcept
+       {
+        m_bom_to_check = false;
+        const auto [enc, bom_size] = detect_encoding_of(m_in_bytes);
+        if( enc==INENC )
+           {
+            m_in_bytes.erase(0, bom_size);
+           }
+        else if( INENC==Enc::UTF16LE and enc==Enc::UTF32LE )
+           {// A utf-16le bom followed by a null character
+            m_in_bytes.erase(0, 2);
+           }
+       }
+
+    //-----------------------------------------------------------------------
+    // Encode and send the complete codepoints in the put area to the device
+    [[nodiscard]] bool flush_put_area(const bool also_incomplete)
+       {
+        m_out_bytes.append(pbase(), pptr());
+        setp(m_put_bytes.data(), m_put_bytes.data()+m_put_bytes.size());
+
+        const std::size_t complete_size = also_incomplete ? m_out_bytes.size() : m_out_bytes.size() - details::incomplete_tail_size<OUTENC>(m_out_bytes);
+        if( complete_size>0 )
+           {
+            const std::string encoded = reencode<OUTENC,INENC>(std::string_view(m_out_bytes).substr(0,complete_size));
+            m_out_bytes.erase(0, complete_size);
+            const auto encoded_size = static_cast<std::streamsize>(encoded.size());
+            if( m_device.sputn(encoded.data(), encoded_size)!=encoded_size )
+               {
+                return false;
+               }
+           }
+        return true;
+       }
+};
+
+
+
+/// [Split in frames]
+
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace details
+{
+    // A frame must have room for the longest codepoint
+    inline constexpr std::size_t min_frame_size = 4;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// The frames of at most a given size of a byte buffer, never cutting a
+// codepoint: each cut point is found jumping ahead of the maximum size
+// and stepping back the bytes of an incomplete codepoint, if any
+// for( const std::string_view frame : utxt::split_at_boundaries<UTF8>(bytes, 4096) ) send(frame);
+template<Enc ENC>
+class frames_t final
+{
+ public:
+    class iterator final
+       {
+         public:
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+
+         private:
+            std::string_view m_frame;
+            std::string_view m_rest; // The bytes after the current frame
+            std::size_t m_max_bytes = details::min_frame_size;
+
+         public:
+            constexpr iterator() noexcept = default;
+            constexpr iterator(const std::string_view bytes, const std::size_t max_bytes) noexcept
+              : m_frame{bytes.substr(0,0)}
+              , m_rest{bytes}
+              , m_max_bytes{max_bytes}
+               {
+                next_frame();
+               }
+
+            [[nodiscard]] constexpr std::string_view operator*() const noexcept { return m_frame; }
+            constexpr iterator& operator++() noexcept { next_frame(); return *this; }
+            constexpr iterator operator++(int) noexcept { iterator prev = *this; next_frame(); return prev; }
+
+            [[nodiscard]] constexpr bool operator==(const iterator& other) const noexcept
+               {
+                return m_frame.data()==other.m_frame.data() and m_frame.size()==other.m_frame.size();
+               }
+            [[nodiscard]] constexpr bool operator==(std::default_sentinel_t) const noexcept
+               {
+                return m_frame.empty();
+               }
+
+         private:
+            constexpr void next_frame() noexcept
+               {
+                std::size_t frame_size = m_rest.size();
+                if( frame_size>m_max_bytes )
+                   {
+                    frame_size = m_max_bytes - details::incomplete_tail_size<ENC>(m_rest.substr(0, m_max_bytes));
+                   }
+                m_frame = m_rest.substr(0, frame_size);
+                m_rest.remove_prefix(frame_size);
+               }
+       };
+
+ private:
+    std::string_view m_bytes;
+    std::size_t m_max_bytes;
+
+ public:
+    constexpr frames_t(const std::string_view bytes, const std::size_t max_bytes) noexcept
+      : m_bytes{bytes}
+      , m_max_bytes{std::max(max_bytes, details::min_frame_size)}
+       {
+        assert( max_bytes>=details::min_frame_size );
+       }
+
+    [[nodiscard]] constexpr iterator begin() const noexcept { return iterator(m_bytes, m_max_bytes); }
+    [[nodiscard]] constexpr std::default_sentinel_t end() const noexcept { return {}; }
+};
+
+//---------------------------------------------------------------------------
+// Frames of at most max_bytes (at least four) of bytes encoded as ENC
+template<Enc ENC>
+[[nodiscard]] constexpr frames_t<ENC> split_at_boundaries(const std::string_view bytes, const std::size_t max_bytes) noexcept
+{
+    return frames_t<ENC>(bytes, max_bytes);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// The frames of at most a given size of a byte buffer re-encoded from
+// INENC to OUTENC, each one encoded on the fly when reached
+// for( const std::string& frame : utxt::split_at_boundaries<UTF8,UTF16BE>(bytes, 140) ) send(frame);
+template<Enc INENC, Enc OUTENC>
+class transcoded_frames_t final
+{
+ public:
+    class iterator final
+       {
+         public:
+            using value_type = std::string;
+            using difference_type = std::ptrdiff_t;
+
+         private:
+            utxt::bytes_buffer_t<INENC> m_bytes_buf{std::string_view{}};
+            std::size_t m_max_bytes = details::min_frame_size;
+            std::size_t m_frame_in_offset = 0; // To compare iterators
+            std::string m_frame;
+
+         public:
+            iterator() = default;
+            iterator(const std::string_view bytes, const std::size_t max_bytes)
+              : m_bytes_buf{bytes}
+              , m_max_bytes{max_bytes}
+               {
+                next_frame();
+               }
+
+            [[nodiscard]] const std::string& operator*() const noexcept { return m_frame; }
+            iterator& operator++() { next_frame(); return *this; }
+            iterator operator++(int) { iterator prev = *this; next_frame(); return prev; }
+
+            [[nodiscard]] bool operator==(const iterator& other) const noexcept
+               {
+                return m_frame_in_offset==other.m_frame_in_offset and m_frame.size()==other.m_frame.size();
+               }
+            [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept
+               {
+                return m_frame.empty();
+               }
+
+         private:
+            void next_frame()
+               {
+                m_frame_in_offset = m_bytes_buf.byte_pos();
+                m_frame.clear();
+                while( m_bytes_buf.has_bytes() )
+                   {
+                    const auto context = m_bytes_buf.save_context();
+                    const char32_t codepoint = details::next_codepoint_of(m_bytes_buf);
+                    if( m_frame.size()+encoded_size_of<OUTENC>(codepoint)>m_max_bytes )
+                       {// Doesn't fit, will be in the next frame
+                        m_bytes_buf.restore_context(context);
+                        break;
+                       }
+                    append_codepoint<OUTENC>(codepoint, m_frame);
+                   }
+               }
+       };
+
+ private:
+    std::string_view m_bytes;
+    std::size_t m_max_bytes;
+
+ public:
+    transcoded_frames_t(const std::string_view bytes, const std::size_t max_bytes) noexcept
+      : m_bytes{bytes}
+      , m_max_bytes{std::max(max_bytes, details::min_frame_size)}
+       {
+        assert( max_bytes>=details::min_frame_size );
+       }
+
+    [[nodiscard]] iterator begin() const { return iterator(m_bytes, m_max_bytes); }
+    [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+};
 
-[[nodiscard]] /*constexpr*/ std::u32string to_utf32(const std::u8string_view utf8str)
+//---------------------------------------------------------------------------
+// Frames of at most max_bytes (at least four) of bytes re-encoded from INENC to OUTENC
+template<Enc INENC, Enc OUTENC>
+[[nodiscard]] transcoded_frames_t<INENC,OUTENC> split_at_boundaries(const std::string_view bytes, const std::size_t max_bytes) noexcept
 {
-    return to_utf32<utxt::Enc::UTF8>( std::string_view(reinterpret_cast<const char*>(utf8str.data()), utf8str.size()) );
+    return transcoded_frames_t<INENC,OUTENC>(bytes, max_bytes);
 }
 
 
 
-/// [Encode utf-32 to bytes]
+/// [Identifiers]
 
-//---------------------------------------------------------------------------
-// Encode a char32_t sequence to OUTENC
-// const std::string out_bytes = utxt::encode_as<UTF16LE>(U"abc");
-//-----------------------------------------------------------------------
-template<utxt::Enc OUTENC>
-[[nodiscard]] constexpr std::string encode_as(const std::u32string_view u32str)
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace details
 {
-    std::string out_bytes;
+    struct codepoint_range_t final { char32_t first; char32_t last; };
 
-    // Assuming the worst case: four bytes per codepoint
-    out_bytes.reserve( 4 * u32str.size() );
+    /////////////////////////////////////////////////////////////////////////
+    // Two level trie of the XID properties bitmaps: the codepoints are
+    // grouped in blocks of 256, the identical ones are stored once
+    struct xid_block_t final
+       {
+        std::uint64_t start_bits[4];
+        std::uint64_t continue_bits[4];
+       };
+    inline constexpr std::size_t xid_block_size = 256;
 
-    for( const char32_t codepoint : u32str )
+    // [generated by tools/gen_xid_tables.py, do not edit]
+    // Codepoints with the XID_Start and XID_Continue properties (Unicode 14.0)
+    inline constexpr codepoint_range_t xid_start_ranges[] =
        {
-        append_codepoint<OUTENC>(codepoint, out_bytes);
+        {0x0041,0x005A},{0x0061,0x007A},{0x00AA,0x00AA},{0x00B5,0x00B5},{0x00BA,0x00BA},{0x00C0,0x00D6},
+        {0x00D8,0x00F6},{0x00F8,0x02C1},{0x02C6,0x02D1},{0x02E0,0x02E4},{0x02EC,0x02EC},{0x02EE,0x02EE},
+        {0x0370,0x0374},{0x0376,0x0377},{0x037B,0x037D},{0x037F,0x037F},{0x0386,0x0386},{0x0388,0x038A},
+        {0x038C,0x038C},{0x038E,0x03A1},{0x03A3,0x03F5},{0x03F7,0x0481},{0x048A,0x052F},{0x0531,0x0556},
+        {0x0559,0x0559},{0x0560,0x0588},{0x05D0,0x05EA},{0x05EF,0x05F2},{0x0620,0x064A},{0x066E,0x066F},
+        {0x0671,0x06D3},{0x06D5,0x06D5},{0x06E5,0x06E6},{0x06EE,0x06EF},{0x06FA,0x06FC},{0x06FF,0x06FF},
+        {0x0710,0x0710},{0x0712,0x072F},{0x074D,0x07A5},{0x07B1,0x07B1},{0x07CA,0x07EA},{0x07F4,0x07F5},
+        {0x07FA,0x07FA},{0x0800,0x0815},{0x081A,0x081A},{0x0824,0x0824},{0x0828,0x0828},{0x0840,0x0858},
+        {0x0860,0x086A},{0x0870,0x0887},{0x0889,0x088E},{0x08A0,0x08C9},{0x0904,0x0939},{0x093D,0x093D},
+        {0x0950,0x0950},{0x0958,0x0961},{0x0971,0x0980},{0x0985,0x098C},{0x098F,0x0990},{0x0993,0x09A8},
+        {0x09AA,0x09B0},{0x09B2,0x09B2},{0x09B6,0x09B9},{0x09BD,0x09BD},{0x09CE,0x09CE},{0x09DC,0x09DD},
+        {0x09DF,0x09E1},{0x09F0,0x09F1},{0x09FC,0x09FC},{0x0A05,0x0A0A},{0x0A0F,0x0A10},{0x0A13,0x0A28},
+        {0x0A2A,0x0A30},{0x0A32,0x0A33},{0x0A35,0x0A36},{0x0A38,0x0A39},{0x0A59,0x0A5C},{0x0A5E,0x0A5E},
+        {0x0A72,0x0A74},{0x0A85,0x0A8D},{0x0A8F,0x0A91},{0x0A93,0x0AA8},{0x0AAA,0x0AB0},{0x0AB2,0x0AB3},
+        {0x0AB5,0x0AB9},{0x0ABD,0x0ABD},{0x0AD0,0x0AD0},{0x0AE0,0x0AE1},{0x0AF9,0x0AF9},{0x0B05,0x0B0C},
+        {0x0B0F,0x0B10},{0x0B13,0x0B28},{0x0B2A,0x0B30},{0x0B32,0x0B33},{0x0B35,0x0B39},{0x0B3D,0x0B3D},
+        {0x0B5C,0x0B5D},{0x0B5F,0x0B61},{0x0B71,0x0B71},{0x0B83,0x0B83},{0x0B85,0x0B8A},{0x0B8E,0x0B90},
+        {0x0B92,0x0B95},{0x0B99,0x0B9A},{0x0B9C,0x0B9C},{0x0B9E,0x0B9F},{0x0BA3,0x0BA4},{0x0BA8,0x0BAA},
+        {0x0BAE,0x0BB9},{0x0BD0,0x0BD0},{0x0C05,0x0C0C},{0x0C0E,0x0C10},{0x0C12,0x0C28},{0x0C2A,0x0C39},
+        {0x0C3D,0x0C3D},{0x0C58,0x0C5A},{0x0C5D,0x0C5D},{0x0C60,0x0C61},{0x0C80,0x0C80},{0x0C85,0x0C8C},
+        {0x0C8E,0x0C90},{0x0C92,0x0CA8},{0x0CAA,0x0CB3},{0x0CB5,0x0CB9},{0x0CBD,0x0CBD},{0x0CDD,0x0CDE},
+        {0x0CE0,0x0CE1},{0x0CF1,0x0CF2},{0x0D04,0x0D0C},{0x0D0E,0x0D10},{0x0D12,0x0D3A},{0x0D3D,0x0D3D},
+        {0x0D4E,0x0D4E},{0x0D54,0x0D56},{0x0D5F,0x0D61},{0x0D7A,0x0D7F},{0x0D85,0x0D96},{0x0D9A,0x0DB1},
+        {0x0DB3,0x0DBB},{0x0DBD,0x0DBD},{0x0DC0,0x0DC6},{0x0E01,0x0E30},{0x0E32,0x0E32},{0x0E40,0x0E46},
+        {0x0E81,0x0E82},{0x0E84,0x0E84},{0x0E86,0x0E8A},{0x0E8C,0x0EA3},{0x0EA5,0x0EA5},{0x0EA7,0x0EB0},
+        {0x0EB2,0x0EB2},{0x0EBD,0x0EBD},{0x0EC0,0x0EC4},{0x0EC6,0x0EC6},{0x0EDC,0x0EDF},{0x0F00,0x0F00},
+        {0x0F40,0x0F47},{0x0F49,0x0F6C},{0x0F88,0x0F8C},{0x1000,0x102A},{0x103F,0x103F},{0x1050,0x1055},
+        {0x105A,0x105D},{0x1061,0x1061},{0x1065,0x1066},{0x106E,0x1070},{0x1075,0x1081},{0x108E,0x108E},
+        {0x10A0,0x10C5},{0x10C7,0x10C7},{0x10CD,0x10CD},{0x10D0,0x10FA},{0x10FC,0x1248},{0x124A,0x124D},
+        {0x1250,0x1256},{0x1258,0x1258},{0x125A,0x125D},{0x1260,0x1288},{0x128A,0x128D},{0x1290,0x12B0},
+        {0x12B2,0x12B5},{0x12B8,0x12BE},{0x12C0,0x12C0},{0x12C2,0x12C5},{0x12C8,0x12D6},{0x12D8,0x1310},
+        {0x1312,0x1315},{0x1318,0x135A},{0x1380,0x138F},{0x13A0,0x13F5},{0x13F8,0x13FD},{0x1401,0x166C},
+        {0x166F,0x167F},{0x1681,0x169A},{0x16A0,0x16EA},{0x16EE,0x16F8},{0x1700,0x1711},{0x171F,0x1731},
+        {0x1740,0x1751},{0x1760,0x176C},{0x176E,0x1770},{0x1780,0x17B3},{0x17D7,0x17D7},{0x17DC,0x17DC},
+        {0x1820,0x1878},{0x1880,0x18A8},{0x18AA,0x18AA},{0x18B0,0x18F5},{0x1900,0x191E},{0x1950,0x196D},
+        {0x1970,0x1974},{0x1980,0x19AB},{0x19B0,0x19C9},{0x1A00,0x1A16},{0x1A20,0x1A54},{0x1AA7,0x1AA7},
+        {0x1B05,0x1B33},{0x1B45,0x1B4C},{0x1B83,0x1BA0},{0x1BAE,0x1BAF},{0x1BBA,0x1BE5},{0x1C00,0x1C23},
+        {0x1C4D,0x1C4F},{0x1C5A,0x1C7D},{0x1C80,0x1C88},{0x1C90,0x1CBA},{0x1CBD,0x1CBF},{0x1CE9,0x1CEC},
+        {0x1CEE,0x1CF3},{0x1CF5,0x1CF6},{0x1CFA,0x1CFA},{0x1D00,0x1DBF},{0x1E00,0x1F15},{0x1F18,0x1F1D},
+        {0x1F20,0x1F45},{0x1F48,0x1F4D},{0x1F50,0x1F57},{0x1F59,0x1F59},{0x1F5B,0x1F5B},{0x1F5D,0x1F5D},
+        {0x1F5F,0x1F7D},{0x1F80,0x1FB4},{0x1FB6,0x1FBC},{0x1FBE,0x1FBE},{0x1FC2,0x1FC4},{0x1FC6,0x1FCC},
+        {0x1FD0,0x1FD3},{0x1FD6,0x1FDB},{0x1FE0,0x1FEC},{0x1FF2,0x1FF4},{0x1FF6,0x1FFC},{0x2071,0x2071},
+        {0x207F,0x207F},{0x2090,0x209C},{0x2102,0x2102},{0x2107,0x2107},{0x210A,0x2113},{0x2115,0x2115},
+        {0x2118,0x211D},{0x2124,0x2124},{0x2126,0x2126},{0x2128,0x2128},{0x212A,0x2139},{0x213C,0x213F},
+        {0x2145,0x2149},{0x214E,0x214E},{0x2160,0x2188},{0x2C00,0x2CE4},{0x2CEB,0x2CEE},{0x2CF2,0x2CF3},
+        {0x2D00,0x2D25},{0x2D27,0x2D27},{0x2D2D,0x2D2D},{0x2D30,0x2D67},{0x2D6F,0x2D6F},{0x2D80,0x2D96},
+        {0x2DA0,0x2DA6},{0x2DA8,0x2DAE},{0x2DB0,0x2DB6},{0x2DB8,0x2DBE},{0x2DC0,0x2DC6},{0x2DC8,0x2DCE},
+        {0x2DD0,0x2DD6},{0x2DD8,0x2DDE},{0x3005,0x3007},{0x3021,0x3029},{0x3031,0x3035},{0x3038,0x303C},
+        {0x3041,0x3096},{0x309D,0x309F},{0x30A1,0x30FA},{0x30FC,0x30FF},{0x3105,0x312F},{0x3131,0x318E},
+        {0x31A0,0x31BF},{0x31F0,0x31FF},{0x3400,0x4DBF},{0x4E00,0xA48C},{0xA4D0,0xA4FD},{0xA500,0xA60C},
+        {0xA610,0xA61F},{0xA62A,0xA62B},{0xA640,0xA66E},{0xA67F,0xA69D},{0xA6A0,0xA6EF},{0xA717,0xA71F},
+        {0xA722,0xA788},{0xA78B,0xA7CA},{0xA7D0,0xA7D1},{0xA7D3,0xA7D3},{0xA7D5,0xA7D9},{0xA7F2,0xA801},
+        {0xA803,0xA805},{0xA807,0xA80A},{0xA80C,0xA822},{0xA840,0xA873},{0xA882,0xA8B3},{0xA8F2,0xA8F7},
+        {0xA8FB,0xA8FB},{0xA8FD,0xA8FE},{0xA90A,0xA925},{0xA930,0xA946},{0xA960,0xA97C},{0xA984,0xA9B2},
+        {0xA9CF,0xA9CF},{0xA9E0,0xA9E4},{0xA9E6,0xA9EF},{0xA9FA,0xA9FE},{0xAA00,0xAA28},{0xAA40,0xAA42},
+        {0xAA44,0xAA4B},{0xAA60,0xAA76},{0xAA7A,0xAA7A},{0xAA7E,0xAAAF},{0xAAB1,0xAAB1},{0xAAB5,0xAAB6},
+        {0xAAB9,0xAABD},{0xAAC0,0xAAC0},{0xAAC2,0xAAC2},{0xAADB,0xAADD},{0xAAE0,0xAAEA},{0xAAF2,0xAAF4},
+        {0xAB01,0xAB06},{0xAB09,0xAB0E},{0xAB11,0xAB16},{0xAB20,0xAB26},{0xAB28,0xAB2E},{0xAB30,0xAB5A},
+        {0xAB5C,0xAB69},{0xAB70,0xABE2},{0xAC00,0xD7A3},{0xD7B0,0xD7C6},{0xD7CB,0xD7FB},{0xF900,0xFA6D},
+        {0xFA70,0xFAD9},{0xFB00,0xFB06},{0xFB13,0xFB17},{0xFB1D,0xFB1D},{0xFB1F,0xFB28},{0xFB2A,0xFB36},
+        {0xFB38,0xFB3C},{0xFB3E,0xFB3E},{0xFB40,0xFB41},{0xFB43,0xFB44},{0xFB46,0xFBB1},{0xFBD3,0xFC5D},
+        {0xFC64,0xFD3D},{0xFD50,0xFD8F},{0xFD92,0xFDC7},{0xFDF0,0xFDF9},{0xFE71,0xFE71},{0xFE73,0xFE73},
+        {0xFE77,0xFE77},{0xFE79,0xFE79},{0xFE7B,0xFE7B},{0xFE7D,0xFE7D},{0xFE7F,0xFEFC},{0xFF21,0xFF3A},
+        {0xFF41,0xFF5A},{0xFF66,0xFF9D},{0xFFA0,0xFFBE},{0xFFC2,0xFFC7},{0xFFCA,0xFFCF},{0xFFD2,0xFFD7},
+        {0xFFDA,0xFFDC},{0x10000,0x1000B},{0x1000D,0x10026},{0x10028,0x1003A},{0x1003C,0x1003D},{0x1003F,0x1004D},
+        {0x10050,0x1005D},{0x10080,0x100FA},{0x10140,0x10174},{0x10280,0x1029C},{0x102A0,0x102D0},{0x10300,0x1031F},
+        {0x1032D,0x1034A},{0x10350,0x10375},{0x10380,0x1039D},{0x103A0,0x103C3},{0x103C8,0x103CF},{0x103D1,0x103D5},
+        {0x10400,0x1049D},{0x104B0,0x104D3},{0x104D8,0x104FB},{0x10500,0x10527},{0x10530,0x10563},{0x10570,0x1057A},
+        {0x1057C,0x1058A},{0x1058C,0x10592},{0x10594,0x10595},{0x10597,0x105A1},{0x105A3,0x105B1},{0x105B3,0x105B9},
+        {0x105BB,0x105BC},{0x10600,0x10736},{0x10740,0x10755},{0x10760,0x10767},{0x10780,0x10785},{0x10787,0x107B0},
+        {0x107B2,0x107BA},{0x10800,0x10805},{0x10808,0x10808},{0x1080A,0x10835},{0x10837,0x10838},{0x1083C,0x1083C},
+        {0x1083F,0x10855},{0x10860,0x10876},{0x10880,0x1089E},{0x108E0,0x108F2},{0x108F4,0x108F5},{0x10900,0x10915},
+        {0x10920,0x10939},{0x10980,0x109B7},{0x109BE,0x109BF},{0x10A00,0x10A00},{0x10A10,0x10A13},{0x10A15,0x10A17},
+        {0x10A19,0x10A35},{0x10A60,0x10A7C},{0x10A80,0x10A9C},{0x10AC0,0x10AC7},{0x10AC9,0x10AE4},{0x10B00,0x10B35},
+        {0x10B40,0x10B55},{0x10B60,0x10B72},{0x10B80,0x10B91},{0x10C00,0x10C48},{0x10C80,0x10CB2},{0x10CC0,0x10CF2},
+        {0x10D00,0x10D23},{0x10E80,0x10EA9},{0x10EB0,0x10EB1},{0x10F00,0x10F1C},{0x10F27,0x10F27},{0x10F30,0x10F45},
+        {0x10F70,0x10F81},{0x10FB0,0x10FC4},{0x10FE0,0x10FF6},{0x11003,0x11037},{0x11071,0x11072},{0x11075,0x11075},
+        {0x11083,0x110AF},{0x110D0,0x110E8},{0x11103,0x11126},{0x11144,0x11144},{0x11147,0x11147},{0x11150,0x11172},
+        {0x11176,0x11176},{0x11183,0x111B2},{0x111C1,0x111C4},{0x111DA,0x111DA},{0x111DC,0x111DC},{0x11200,0x11211},
+        {0x11213,0x1122B},{0x11280,0x11286},{0x11288,0x11288},{0x1128A,0x1128D},{0x1128F,0x1129D},{0x1129F,0x112A8},
+        {0x112B0,0x112DE},{0x11305,0x1130C},{0x1130F,0x11310},{0x11313,0x11328},{0x1132A,0x11330},{0x11332,0x11333},
+        {0x11335,0x11339},{0x1133D,0x1133D},{0x11350,0x11350},{0x1135D,0x11361},{0x11400,0x11434},{0x11447,0x1144A},
+        {0x1145F,0x11461},{0x11480,0x114AF},{0x114C4,0x114C5},{0x114C7,0x114C7},{0x11580,0x115AE},{0x115D8,0x115DB},
+        {0x11600,0x1162F},{0x11644,0x11644},{0x11680,0x116AA},{0x116B8,0x116B8},{0x11700,0x1171A},{0x11740,0x11746},
+        {0x11800,0x1182B},{0x118A0,0x118DF},{0x118FF,0x11906},{0x11909,0x11909},{0x1190C,0x11913},{0x11915,0x11916},
+        {0x11918,0x1192F},{0x1193F,0x1193F},{0x11941,0x11941},{0x119A0,0x119A7},{0x119AA,0x119D0},{0x119E1,0x119E1},
+        {0x119E3,0x119E3},{0x11A00,0x11A00},{0x11A0B,0x11A32},{0x11A3A,0x11A3A},{0x11A50,0x11A50},{0x11A5C,0x11A89},
+        {0x11A9D,0x11A9D},{0x11AB0,0x11AF8},{0x11C00,0x11C08},{0x11C0A,0x11C2E},{0x11C40,0x11C40},{0x11C72,0x11C8F},
+        {0x11D00,0x11D06},{0x11D08,0x11D09},{0x11D0B,0x11D30},{0x11D46,0x11D46},{0x11D60,0x11D65},{0x11D67,0x11D68},
+        {0x11D6A,0x11D89},{0x11D98,0x11D98},{0x11EE0,0x11EF2},{0x11FB0,0x11FB0},{0x12000,0x12399},{0x12400,0x1246E},
+        {0x12480,0x12543},{0x12F90,0x12FF0},{0x13000,0x1342E},{0x14400,0x14646},{0x16800,0x16A38},{0x16A40,0x16A5E},
+        {0x16A70,0x16ABE},{0x16AD0,0x16AED},{0x16B00,0x16B2F},{0x16B40,0x16B43},{0x16B63,0x16B77},{0x16B7D,0x16B8F},
+        {0x16E40,0x16E7F},{0x16F00,0x16F4A},{0x16F50,0x16F50},{0x16F93,0x16F9F},{0x16FE0,0x16FE1},{0x16FE3,0x16FE3},
+        {0x17000,0x187F7},{0x18800,0x18CD5},{0x18D00,0x18D08},{0x1AFF0,0x1AFF3},{0x1AFF5,0x1AFFB},{0x1AFFD,0x1AFFE},
+        {0x1B000,0x1B122},{0x1B150,0x1B152},{0x1B164,0x1B167},{0x1B170,0x1B2FB},{0x1BC00,0x1BC6A},{0x1BC70,0x1BC7C},
+        {0x1BC80,0x1BC88},{0x1BC90,0x1BC99},{0x1D400,0x1D454},{0x1D456,0x1D49C},{0x1D49E,0x1D49F},{0x1D4A2,0x1D4A2},
+        {0x1D4A5,0x1D4A6},{0x1D4A9,0x1D4AC},{0x1D4AE,0x1D4B9},{0x1D4BB,0x1D4BB},{0x1D4BD,0x1D4C3},{0x1D4C5,0x1D505},
+        {0x1D507,0x1D50A},{0x1D50D,0x1D514},{0x1D516,0x1D51C},{0x1D51E,0x1D539},{0x1D53B,0x1D53E},{0x1D540,0x1D544},
+        {0x1D546,0x1D546},{0x1D54A,0x1D550},{0x1D552,0x1D6A5},{0x1D6A8,0x1D6C0},{0x1D6C2,0x1D6DA},{0x1D6DC,0x1D6FA},
+        {0x1D6FC,0x1D714},{0x1D716,0x1D734},{0x1D736,0x1D74E},{0x1D750,0x1D76E},{0x1D770,0x1D788},{0x1D78A,0x1D7A8},
+        {0x1D7AA,0x1D7C2},{0x1D7C4,0x1D7CB},{0x1DF00,0x1DF1E},{0x1E100,0x1E12C},{0x1E137,0x1E13D},{0x1E14E,0x1E14E},
+        {0x1E290,0x1E2AD},{0x1E2C0,0x1E2EB},{0x1E7E0,0x1E7E6},{0x1E7E8,0x1E7EB},{0x1E7ED,0x1E7EE},{0x1E7F0,0x1E7FE},
+        {0x1E800,0x1E8C4},{0x1E900,0x1E943},{0x1E94B,0x1E94B},{0x1EE00,0x1EE03},{0x1EE05,0x1EE1F},{0x1EE21,0x1EE22},
+        {0x1EE24,0x1EE24},{0x1EE27,0x1EE27},{0x1EE29,0x1EE32},{0x1EE34,0x1EE37},{0x1EE39,0x1EE39},{0x1EE3B,0x1EE3B},
+        {0x1EE42,0x1EE42},{0x1EE47,0x1EE47},{0x1EE49,0x1EE49},{0x1EE4B,0x1EE4B},{0x1EE4D,0x1EE4F},{0x1EE51,0x1EE52},
+        {0x1EE54,0x1EE54},{0x1EE57,0x1EE57},{0x1EE59,0x1EE59},{0x1EE5B,0x1EE5B},{0x1EE5D,0x1EE5D},{0x1EE5F,0x1EE5F},
+        {0x1EE61,0x1EE62},{0x1EE64,0x1EE64},{0x1EE67,0x1EE6A},{0x1EE6C,0x1EE72},{0x1EE74,0x1EE77},{0x1EE79,0x1EE7C},
+        {0x1EE7E,0x1EE7E},{0x1EE80,0x1EE89},{0x1EE8B,0x1EE9B},{0x1EEA1,0x1EEA3},{0x1EEA5,0x1EEA9},{0x1EEAB,0x1EEBB},
+        {0x20000,0x2A6DF},{0x2A700,0x2B738},{0x2B740,0x2B81D},{0x2B820,0x2CEA1},{0x2CEB0,0x2EBE0},{0x2F800,0x2FA1D},
+        {0x30000,0x3134A}
+       };
+
+    // The continuation ones, that include the XID_Start ones
+    inline constexpr codepoint_range_t xid_continue_ranges[] =
+       {
+        {0x0030,0x0039},{0x0041,0x005A},{0x005F,0x005F},{0x0061,0x007A},{0x00AA,0x00AA},{0x00B5,0x00B5},
+        {0x00B7,0x00B7},{0x00BA,0x00BA},{0x00C0,0x00D6},{0x00D8,0x00F6},{0x00F8,0x02C1},{0x02C6,0x02D1},
+        {0x02E0,0x02E4},{0x02EC,0x02EC},{0x02EE,0x02EE},{0x0300,0x0374},{0x0376,0x0377},{0x037B,0x037D},
+        {0x037F,0x037F},{0x0386,0x038A},{0x038C,0x038C},{0x038E,0x03A1},{0x03A3,0x03F5},{0x03F7,0x0481},
+        {0x0483,0x0487},{0x048A,0x052F},{0x0531,0x0556},{0x0559,0x0559},{0x0560,0x0588},{0x0591,0x05BD},
+        {0x05BF,0x05BF},{0x05C1,0x05C2},{0x05C4,0x05C5},{0x05C7,0x05C7},{0x05D0,0x05EA},{0x05EF,0x05F2},
+        {0x0610,0x061A},{0x0620,0x0669},{0x066E,0x06D3},{0x06D5,0x06DC},{0x06DF,0x06E8},{0x06EA,0x06FC},
+        {0x06FF,0x06FF},{0x0710,0x074A},{0x074D,0x07B1},{0x07C0,0x07F5},{0x07FA,0x07FA},{0x07FD,0x07FD},
+        {0x0800,0x082D},{0x0840,0x085B},{0x0860,0x086A},{0x0870,0x0887},{0x0889,0x088E},{0x0898,0x08E1},
+        {0x08E3,0x0963},{0x0966,0x096F},{0x0971,0x0983},{0x0985,0x098C},{0x098F,0x0990},{0x0993,0x09A8},
+        {0x09AA,0x09B0},{0x09B2,0x09B2},{0x09B6,0x09B9},{0x09BC,0x09C4},{0x09C7,0x09C8},{0x09CB,0x09CE},
+        {0x09D7,0x09D7},{0x09DC,0x09DD},{0x09DF,0x09E3},{0x09E6,0x09F1},{0x09FC,0x09FC},{0x09FE,0x09FE},
+        {0x0A01,0x0A03},{0x0A05,0x0A0A},{0x0A0F,0x0A10},{0x0A13,0x0A28},{0x0A2A,0x0A30},{0x0A32,0x0A33},
+        {0x0A35,0x0A36},{0x0A38,0x0A39},{0x0A3C,0x0A3C},{0x0A3E,0x0A42},{0x0A47,0x0A48},{0x0A4B,0x0A4D},
+        {0x0A51,0x0A51},{0x0A59,0x0A5C},{0x0A5E,0x0A5E},{0x0A66,0x0A75},{0x0A81,0x0A83},{0x0A85,0x0A8D},
+        {0x0A8F,0x0A91},{0x0A93,0x0AA8},{0x0AAA,0x0AB0},{0x0AB2,0x0AB3},{0x0AB5,0x0AB9},{0x0ABC,0x0AC5},
+        {0x0AC7,0x0AC9},{0x0ACB,0x0ACD},{0x0AD0,0x0AD0},{0x0AE0,0x0AE3},{0x0AE6,0x0AEF},{0x0AF9,0x0AFF},
+        {0x0B01,0x0B03},{0x0B05,0x0B0C},{0x0B0F,0x0B10},{0x0B13,0x0B28},{0x0B2A,0x0B30},{0x0B32,0x0B33},
+        {0x0B35,0x0B39},{0x0B3C,0x0B44},{0x0B47,0x0B48},{0x0B4B,0x0B4D},{0x0B55,0x0B57},{0x0B5C,0x0B5D},
+        {0x0B5F,0x0B63},{0x0B66,0x0B6F},{0x0B71,0x0B71},{0x0B82,0x0B83},{0x0B85,0x0B8A},{0x0B8E,0x0B90},
+        {0x0B92,0x0B95},{0x0B99,0x0B9A},{0x0B9C,0x0B9C},{0x0B9E,0x0B9F},{0x0BA3,0x0BA4},{0x0BA8,0x0BAA},
+        {0x0BAE,0x0BB9},{0x0BBE,0x0BC2},{0x0BC6,0x0BC8},{0x0BCA,0x0BCD},{0x0BD0,0x0BD0},{0x0BD7,0x0BD7},
+        {0x0BE6,0x0BEF},{0x0C00,0x0C0C},{0x0C0E,0x0C10},{0x0C12,0x0C28},{0x0C2A,0x0C39},{0x0C3C,0x0C44},
+        {0x0C46,0x0C48},{0x0C4A,0x0C4D},{0x0C55,0x0C56},{0x0C58,0x0C5A},{0x0C5D,0x0C5D},{0x0C60,0x0C63},
+        {0x0C66,0x0C6F},{0x0C80,0x0C83},{0x0C85,0x0C8C},{0x0C8E,0x0C90},{0x0C92,0x0CA8},{0x0CAA,0x0CB3},
+        {0x0CB5,0x0CB9},{0x0CBC,0x0CC4},{0x0CC6,0x0CC8},{0x0CCA,0x0CCD},{0x0CD5,0x0CD6},{0x0CDD,0x0CDE},
+        {0x0CE0,0x0CE3},{0x0CE6,0x0CEF},{0x0CF1,0x0CF2},{0x0D00,0x0D0C},{0x0D0E,0x0D10},{0x0D12,0x0D44},
+        {0x0D46,0x0D48},{0x0D4A,0x0D4E},{0x0D54,0x0D57},{0x0D5F,0x0D63},{0x0D66,0x0D6F},{0x0D7A,0x0D7F},
+        {0x0D81,0x0D83},{0x0D85,0x0D96},{0x0D9A,0x0DB1},{0x0DB3,0x0DBB},{0x0DBD,0x0DBD},{0x0DC0,0x0DC6},
+        {0x0DCA,0x0DCA},{0x0DCF,0x0DD4},{0x0DD6,0x0DD6},{0x0DD8,0x0DDF},{0x0DE6,0x0DEF},{0x0DF2,0x0DF3},
+        {0x0E01,0x0E3A},{0x0E40,0x0E4E},{0x0E50,0x0E59},{0x0E81,0x0E82},{0x0E84,0x0E84},{0x0E86,0x0E8A},
+        {0x0E8C,0x0EA3},{0x0EA5,0x0EA5},{0x0EA7,0x0EBD},{0x0EC0,0x0EC4},{0x0EC6,0x0EC6},{0x0EC8,0x0ECD},
+        {0x0ED0,0x0ED9},{0x0EDC,0x0EDF},{0x0F00,0x0F00},{0x0F18,0x0F19},{0x0F20,0x0F29},{0x0F35,0x0F35},
+        {0x0F37,0x0F37},{0x0F39,0x0F39},{0x0F3E,0x0F47},{0x0F49,0x0F6C},{0x0F71,0x0F84},{0x0F86,0x0F97},
+        {0x0F99,0x0FBC},{0x0FC6,0x0FC6},{0x1000,0x1049},{0x1050,0x109D},{0x10A0,0x10C5},{0x10C7,0x10C7},
+        {0x10CD,0x10CD},{0x10D0,0x10FA},{0x10FC,0x1248},{0x124A,0x124D},{0x1250,0x1256},{0x1258,0x1258},
+        {0x125A,0x125D},{0x1260,0x1288},{0x128A,0x128D},{0x1290,0x12B0},{0x12B2,0x12B5},{0x12B8,0x12BE},
+        {0x12C0,0x12C0},{0x12C2,0x12C5},{0x12C8,0x12D6},{0x12D8,0x1310},{0x1312,0x1315},{0x1318,0x135A},
+        {0x135D,0x135F},{0x1369,0x1371},{0x1380,0x138F},{0x13A0,0x13F5},{0x13F8,0x13FD},{0x1401,0x166C},
+        {0x166F,0x167F},{0x1681,0x169A},{0x16A0,0x16EA},{0x16EE,0x16F8},{0x1700,0x1715},{0x171F,0x1734},
+        {0x1740,0x1753},{0x1760,0x176C},{0x176E,0x1770},{0x1772,0x1773},{0x1780,0x17D3},{0x17D7,0x17D7},
+        {0x17DC,0x17DD},{0x17E0,0x17E9},{0x180B,0x180D},{0x180F,0x1819},{0x1820,0x1878},{0x1880,0x18AA},
+        {0x18B0,0x18F5},{0x1900,0x191E},{0x1920,0x192B},{0x1930,0x193B},{0x1946,0x196D},{0x1970,0x1974},
+        {0x1980,0x19AB},{0x19B0,0x19C9},{0x19D0,0x19DA},{0x1A00,0x1A1B},{0x1A20,0x1A5E},{0x1A60,0x1A7C},
+        {0x1A7F,0x1A89},{0x1A90,0x1A99},{0x1AA7,0x1AA7},{0x1AB0,0x1ABD},{0x1ABF,0x1ACE},{0x1B00,0x1B4C},
+        {0x1B50,0x1B59},{0x1B6B,0x1B73},{0x1B80,0x1BF3},{0x1C00,0x1C37},{0x1C40,0x1C49},{0x1C4D,0x1C7D},
+        {0x1C80,0x1C88},{0x1C90,0x1CBA},{0x1CBD,0x1CBF},{0x1CD0,0x1CD2},{0x1CD4,0x1CFA},{0x1D00,0x1F15},
+        {0x1F18,0x1F1D},{0x1F20,0x1F45},{0x1F48,0x1F4D},{0x1F50,0x1F57},{0x1F59,0x1F59},{0x1F5B,0x1F5B},
+        {0x1F5D,0x1F5D},{0x1F5F,0x1F7D},{0x1F80,0x1FB4},{0x1FB6,0x1FBC},{0x1FBE,0x1FBE},{0x1FC2,0x1FC4},
+        {0x1FC6,0x1FCC},{0x1FD0,0x1FD3},{0x1FD6,0x1FDB},{0x1FE0,0x1FEC},{0x1FF2,0x1FF4},{0x1FF6,0x1FFC},
+        {0x203F,0x2040},{0x2054,0x2054},{0x2071,0x2071},{0x207F,0x207F},{0x2090,0x209C},{0x20D0,0x20DC},
+        {0x20E1,0x20E1},{0x20E5,0x20F0},{0x2102,0x2102},{0x2107,0x2107},{0x210A,0x2113},{0x2115,0x2115},
+        {0x2118,0x211D},{0x2124,0x2124},{0x2126,0x2126},{0x2128,0x2128},{0x212A,0x2139},{0x213C,0x213F},
+        {0x2145,0x2149},{0x214E,0x214E},{0x2160,0x2188},{0x2C00,0x2CE4},{0x2CEB,0x2CF3},{0x2D00,0x2D25},
+        {0x2D27,0x2D27},{0x2D2D,0x2D2D},{0x2D30,0x2D67},{0x2D6F,0x2D6F},{0x2D7F,0x2D96},{0x2DA0,0x2DA6},
+        {0x2DA8,0x2DAE},{0x2DB0,0x2DB6},{0x2DB8,0x2DBE},{0x2DC0,0x2DC6},{0x2DC8,0x2DCE},{0x2DD0,0x2DD6},
+        {0x2DD8,0x2DDE},{0x2DE0,0x2DFF},{0x3005,0x3007},{0x3021,0x302F},{0x3031,0x3035},{0x3038,0x303C},
+        {0x3041,0x3096},{0x3099,0x309A},{0x309D,0x309F},{0x30A1,0x30FA},{0x30FC,0x30FF},{0x3105,0x312F},
+        {0x3131,0x318E},{0x31A0,0x31BF},{0x31F0,0x31FF},{0x3400,0x4DBF},{0x4E00,0xA48C},{0xA4D0,0xA4FD},
+        {0xA500,0xA60C},{0xA610,0xA62B},{0xA640,0xA66F},{0xA674,0xA67D},{0xA67F,0xA6F1},{0xA717,0xA71F},
+        {0xA722,0xA788},{0xA78B,0xA7CA},{0xA7D0,0xA7D1},{0xA7D3,0xA7D3},{0xA7D5,0xA7D9},{0xA7F2,0xA827},
+        {0xA82C,0xA82C},{0xA840,0xA873},{0xA880,0xA8C5},{0xA8D0,0xA8D9},{0xA8E0,0xA8F7},{0xA8FB,0xA8FB},
+        {0xA8FD,0xA92D},{0xA930,0xA953},{0xA960,0xA97C},{0xA980,0xA9C0},{0xA9CF,0xA9D9},{0xA9E0,0xA9FE},
+        {0xAA00,0xAA36},{0xAA40,0xAA4D},{0xAA50,0xAA59},{0xAA60,0xAA76},{0xAA7A,0xAAC2},{0xAADB,0xAADD},
+        {0xAAE0,0xAAEF},{0xAAF2,0xAAF6},{0xAB01,0xAB06},{0xAB09,0xAB0E},{0xAB11,0xAB16},{0xAB20,0xAB26},
+        {0xAB28,0xAB2E},{0xAB30,0xAB5A},{0xAB5C,0xAB69},{0xAB70,0xABEA},{0xABEC,0xABED},{0xABF0,0xABF9},
+        {0xAC00,0xD7A3},{0xD7B0,0xD7C6},{0xD7CB,0xD7FB},{0xF900,0xFA6D},{0xFA70,0xFAD9},{0xFB00,0xFB06},
+        {0xFB13,0xFB17},{0xFB1D,0xFB28},{0xFB2A,0xFB36},{0xFB38,0xFB3C},{0xFB3E,0xFB3E},{0xFB40,0xFB41},
+        {0xFB43,0xFB44},{0xFB46,0xFBB1},{0xFBD3,0xFC5D},{0xFC64,0xFD3D},{0xFD50,0xFD8F},{0xFD92,0xFDC7},
+        {0xFDF0,0xFDF9},{0xFE00,0xFE0F},{0xFE20,0xFE2F},{0xFE33,0xFE34},{0xFE4D,0xFE4F},{0xFE71,0xFE71},
+        {0xFE73,0xFE73},{0xFE77,0xFE77},{0xFE79,0xFE79},{0xFE7B,0xFE7B},{0xFE7D,0xFE7D},{0xFE7F,0xFEFC},
+        {0xFF10,0xFF19},{0xFF21,0xFF3A},{0xFF3F,0xFF3F},{0xFF41,0xFF5A},{0xFF66,0xFFBE},{0xFFC2,0xFFC7},
+        {0xFFCA,0xFFCF},{0xFFD2,0xFFD7},{0xFFDA,0xFFDC},{0x10000,0x1000B},{0x1000D,0x10026},{0x10028,0x1003A},
+        {0x1003C,0x1003D},{0x1003F,0x1004D},{0x10050,0x1005D},{0x10080,0x100FA},{0x10140,0x10174},{0x101FD,0x101FD},
+        {0x10280,0x1029C},{0x102A0,0x102D0},{0x102E0,0x102E0},{0x10300,0x1031F},{0x1032D,0x1034A},{0x10350,0x1037A},
+        {0x10380,0x1039D},{0x103A0,0x103C3},{0x103C8,0x103CF},{0x103D1,0x103D5},{0x10400,0x1049D},{0x104A0,0x104A9},
+        {0x104B0,0x104D3},{0x104D8,0x104FB},{0x10500,0x10527},{0x10530,0x10563},{0x10570,0x1057A},{0x1057C,0x1058A},
+        {0x1058C,0x10592},{0x10594,0x10595},{0x10597,0x105A1},{0x105A3,0x105B1},{0x105B3,0x105B9},{0x105BB,0x105BC},
+        {0x10600,0x10736},{0x10740,0x10755},{0x10760,0x10767},{0x10780,0x10785},{0x10787,0x107B0},{0x107B2,0x107BA},
+        {0x10800,0x10805},{0x10808,0x10808},{0x1080A,0x10835},{0x10837,0x10838},{0x1083C,0x1083C},{0x1083F,0x10855},
+        {0x10860,0x10876},{0x10880,0x1089E},{0x108E0,0x108F2},{0x108F4,0x108F5},{0x10900,0x10915},{0x10920,0x10939},
+        {0x10980,0x109B7},{0x109BE,0x109BF},{0x10A00,0x10A03},{0x10A05,0x10A06},{0x10A0C,0x10A13},{0x10A15,0x10A17},
+        {0x10A19,0x10A35},{0x10A38,0x10A3A},{0x10A3F,0x10A3F},{0x10A60,0x10A7C},{0x10A80,0x10A9C},{0x10AC0,0x10AC7},
+        {0x10AC9,0x10AE6},{0x10B00,0x10B35},{0x10B40,0x10B55},{0x10B60,0x10B72},{0x10B80,0x10B91},{0x10C00,0x10C48},
+        {0x10C80,0x10CB2},{0x10CC0,0x10CF2},{0x10D00,0x10D27},{0x10D30,0x10D39},{0x10E80,0x10EA9},{0x10EAB,0x10EAC},
+        {0x10EB0,0x10EB1},{0x10F00,0x10F1C},{0x10F27,0x10F27},{0x10F30,0x10F50},{0x10F70,0x10F85},{0x10FB0,0x10FC4},
+        {0x10FE0,0x10FF6},{0x11000,0x11046},{0x11066,0x11075},{0x1107F,0x110BA},{0x110C2,0x110C2},{0x110D0,0x110E8},
+        {0x110F0,0x110F9},{0x11100,0x11134},{0x11136,0x1113F},{0x11144,0x11147},{0x11150,0x11173},{0x11176,0x11176},
+        {0x11180,0x111C4},{0x111C9,0x111CC},{0x111CE,0x111DA},{0x111DC,0x111DC},{0x11200,0x11211},{0x11213,0x11237},
+        {0x1123E,0x1123E},{0x11280,0x11286},{0x11288,0x11288},{0x1128A,0x1128D},{0x1128F,0x1129D},{0x1129F,0x112A8},
+        {0x112B0,0x112EA},{0x112F0,0x112F9},{0x11300,0x11303},{0x11305,0x1130C},{0x1130F,0x11310},{0x11313,0x11328},
+        {0x1132A,0x11330},{0x11332,0x11333},{0x11335,0x11339},{0x1133B,0x11344},{0x11347,0x11348},{0x1134B,0x1134D},
+        {0x11350,0x11350},{0x11357,0x11357},{0x1135D,0x11363},{0x11366,0x1136C},{0x11370,0x11374},{0x11400,0x1144A},
+        {0x11450,0x11459},{0x1145E,0x11461},{0x11480,0x114C5},{0x114C7,0x114C7},{0x114D0,0x114D9},{0x11580,0x115B5},
+        {0x115B8,0x115C0},{0x115D8,0x115DD},{0x11600,0x11640},{0x11644,0x11644},{0x11650,0x11659},{0x11680,0x116B8},
+        {0x116C0,0x116C9},{0x11700,0x1171A},{0x1171D,0x1172B},{0x11730,0x11739},{0x11740,0x11746},{0x11800,0x1183A},
+        {0x118A0,0x118E9},{0x118FF,0x11906},{0x11909,0x11909},{0x1190C,0x11913},{0x11915,0x11916},{0x11918,0x11935},
+        {0x11937,0x11938},{0x1193B,0x11943},{0x11950,0x11959},{0x119A0,0x119A7},{0x119AA,0x119D7},{0x119DA,0x119E1},
+        {0x119E3,0x119E4},{0x11A00,0x11A3E},{0x11A47,0x11A47},{0x11A50,0x11A99},{0x11A9D,0x11A9D},{0x11AB0,0x11AF8},
+        {0x11C00,0x11C08},{0x11C0A,0x11C36},{0x11C38,0x11C40},{0x11C50,0x11C59},{0x11C72,0x11C8F},{0x11C92,0x11CA7},
+        {0x11CA9,0x11CB6},{0x11D00,0x11D06},{0x11D08,0x11D09},{0x11D0B,0x11D36},{0x11D3A,0x11D3A},{0x11D3C,0x11D3D},
+        {0x11D3F,0x11D47},{0x11D50,0x11D59},{0x11D60,0x11D65},{0x11D67,0x11D68},{0x11D6A,0x11D8E},{0x11D90,0x11D91},
+        {0x11D93,0x11D98},{0x11DA0,0x11DA9},{0x11EE0,0x11EF6},{0x11FB0,0x11FB0},{0x12000,0x12399},{0x12400,0x1246E},
+        {0x12480,0x12543},{0x12F90,0x12FF0},{0x13000,0x1342E},{0x14400,0x14646},{0x16800,0x16A38},{0x16A40,0x16A5E},
+        {0x16A60,0x16A69},{0x16A70,0x16ABE},{0x16AC0,0x16AC9},{0x16AD0,0x16AED},{0x16AF0,0x16AF4},{0x16B00,0x16B36},
+        {0x16B40,0x16B43},{0x16B50,0x16B59},{0x16B63,0x16B77},{0x16B7D,0x16B8F},{0x16E40,0x16E7F},{0x16F00,0x16F4A},
+        {0x16F4F,0x16F87},{0x16F8F,0x16F9F},{0x16FE0,0x16FE1},{0x16FE3,0x16FE4},{0x16FF0,0x16FF1},{0x17000,0x187F7},
+        {0x18800,0x18CD5},{0x18D00,0x18D08},{0x1AFF0,0x1AFF3},{0x1AFF5,0x1AFFB},{0x1AFFD,0x1AFFE},{0x1B000,0x1B122},
+        {0x1B150,0x1B152},{0x1B164,0x1B167},{0x1B170,0x1B2FB},{0x1BC00,0x1BC6A},{0x1BC70,0x1BC7C},{0x1BC80,0x1BC88},
+        {0x1BC90,0x1BC99},{0x1BC9D,0x1BC9E},{0x1CF00,0x1CF2D},{0x1CF30,0x1CF46},{0x1D165,0x1D169},{0x1D16D,0x1D172},
+        {0x1D17B,0x1D182},{0x1D185,0x1D18B},{0x1D1AA,0x1D1AD},{0x1D242,0x1D244},{0x1D400,0x1D454},{0x1D456,0x1D49C},
+        {0x1D49E,0x1D49F},{0x1D4A2,0x1D4A2},{0x1D4A5,0x1D4A6},{0x1D4A9,0x1D4AC},{0x1D4AE,0x1D4B9},{0x1D4BB,0x1D4BB},
+        {0x1D4BD,0x1D4C3},{0x1D4C5,0x1D505},{0x1D507,0x1D50A},{0x1D50D,0x1D514},{0x1D516,0x1D51C},{0x1D51E,0x1D539},
+        {0x1D53B,0x1D53E},{0x1D540,0x1D544},{0x1D546,0x1D546},{0x1D54A,0x1D550},{0x1D552,0x1D6A5},{0x1D6A8,0x1D6C0},
+        {0x1D6C2,0x1D6DA},{0x1D6DC,0x1D6FA},{0x1D6FC,0x1D714},{0x1D716,0x1D734},{0x1D736,0x1D74E},{0x1D750,0x1D76E},
+        {0x1D770,0x1D788},{0x1D78A,0x1D7A8},{0x1D7AA,0x1D7C2},{0x1D7C4,0x1D7CB},{0x1D7CE,0x1D7FF},{0x1DA00,0x1DA36},
+        {0x1DA3B,0x1DA6C},{0x1DA75,0x1DA75},{0x1DA84,0x1DA84},{0x1DA9B,0x1DA9F},{0x1DAA1,0x1DAAF},{0x1DF00,0x1DF1E},
+        {0x1E000,0x1E006},{0x1E008,0x1E018},{0x1E01B,0x1E021},{0x1E023,0x1E024},{0x1E026,0x1E02A},{0x1E100,0x1E12C},
+        {0x1E130,0x1E13D},{0x1E140,0x1E149},{0x1E14E,0x1E14E},{0x1E290,0x1E2AE},{0x1E2C0,0x1E2F9},{0x1E7E0,0x1E7E6},
+        {0x1E7E8,0x1E7EB},{0x1E7ED,0x1E7EE},{0x1E7F0,0x1E7FE},{0x1E800,0x1E8C4},{0x1E8D0,0x1E8D6},{0x1E900,0x1E94B},
+        {0x1E950,0x1E959},{0x1EE00,0x1EE03},{0x1EE05,0x1EE1F},{0x1EE21,0x1EE22},{0x1EE24,0x1EE24},{0x1EE27,0x1EE27},
+        {0x1EE29,0x1EE32},{0x1EE34,0x1EE37},{0x1EE39,0x1EE39},{0x1EE3B,0x1EE3B},{0x1EE42,0x1EE42},{0x1EE47,0x1EE47},
+        {0x1EE49,0x1EE49},{0x1EE4B,0x1EE4B},{0x1EE4D,0x1EE4F},{0x1EE51,0x1EE52},{0x1EE54,0x1EE54},{0x1EE57,0x1EE57},
+        {0x1EE59,0x1EE59},{0x1EE5B,0x1EE5B},{0x1EE5D,0x1EE5D},{0x1EE5F,0x1EE5F},{0x1EE61,0x1EE62},{0x1EE64,0x1EE64},
+        {0x1EE67,0x1EE6A},{0x1EE6C,0x1EE72},{0x1EE74,0x1EE77},{0x1EE79,0x1EE7C},{0x1EE7E,0x1EE7E},{0x1EE80,0x1EE89},
+        {0x1EE8B,0x1EE9B},{0x1EEA1,0x1EEA3},{0x1EEA5,0x1EEA9},{0x1EEAB,0x1EEBB},{0x1FBF0,0x1FBF9},{0x20000,0x2A6DF},
+        {0x2A700,0x2B738},{0x2B740,0x2B81D},{0x2B820,0x2CEA1},{0x2CEB0,0x2EBE0},{0x2F800,0x2FA1D},{0x30000,0x3134A},
+        {0xE0100,0xE01EF}
+       };
+
+    // The block of each 256 codepoints
+    inline constexpr std::uint8_t xid_block_index[0x110000/xid_block_size] =
+       {
+        1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,2,18,19,20,2,21,22,23,24,25,26,27,28,2,29,
+        30,31,0,0,0,0,0,0,0,0,0,0,32,33,0,0,34,35,0,0,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,36,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,37,2,38,39,40,41,42,43,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,44,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,45,46,47,48,49,50,
+        51,52,53,54,55,56,2,57,58,59,60,61,62,63,64,65,66,67,68,69,70,71,72,73,74,75,76,0,77,78,79,80,
+        2,2,2,81,82,83,0,0,0,0,0,0,0,0,0,84,2,2,2,2,85,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,2,2,86,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,2,2,87,88,0,0,89,90,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,91,2,2,2,2,92,93,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,94,2,95,96,0,0,0,0,0,0,0,0,0,97,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,98,0,99,100,0,101,102,103,104,0,0,105,0,0,0,0,106,
+        107,108,109,0,0,0,0,110,111,112,0,0,0,0,113,0,0,0,0,0,0,0,0,0,0,0,0,114,0,0,0,0,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,115,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,116,117,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,118,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        2,2,2,2,2,2,2,2,2,2,2,119,0,0,0,0,0,0,0,0,0,0,0,0,2,2,120,0,0,0,0,0,
+        2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,121,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,122,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+       };
+
+    // The distinct blocks, the first is the empty one
+    inline constexpr xid_block_t xid_blocks[123] =
+       {
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0000000000000000}},
+        {{0x0000000000000000,0x07FFFFFE07FFFFFE,0x0420040000000000,0xFF7FFFFFFF7FFFFF},{0x03FF000000000000,0x07FFFFFE87FFFFFE,0x04A0040000000000,0xFF7FFFFFFF7FFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000501F0003FFC3},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000501F0003FFC3}},
+        {{0x0000000000000000,0xB8DF000000000000,0xFFFFFFFBFFFFD740,0xFFBFFFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xB8DFFFFFFFFFFFFF,0xFFFFFFFBFFFFD7C0,0xFFBFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFC03,0xFFFFFFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFCFB,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFEFFFFFFFFFFFF,0xFFFFFFFF027FFFFF,0x00000000000001FF,0x000787FFFFFF0000},{0xFFFEFFFFFFFFFFFF,0xFFFFFFFF027FFFFF,0xBFFFFFFFFFFE01FF,0x000787FFFFFF00B6}},
+        {{0xFFFFFFFF00000000,0xFFFEC000000007FF,0xFFFFFFFFFFFFFFFF,0x9C00C060002FFFFF},{0xFFFFFFFF07FF0000,0xFFFFC3FFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x9FFFFDFF9FEFFFFF}},
+        {{0x0000FFFFFFFD0000,0xFFFFFFFFFFFFE000,0x0002003FFFFFFFFF,0x043007FFFFFFFC00},{0xFFFFFFFFFFFF0000,0xFFFFFFFFFFFFE7FF,0x0003FFFFFFFFFFFF,0x243FFFFFFFFFFFFF}},
+        {{0x00000110043FFFFF,0xFFFF07FF01FFFFFF,0xFFFFFFFF00007EFF,0x00000000000003FF},{0x00003FFFFFFFFFFF,0xFFFF07FF0FFFFFFF,0xFFFFFFFFFF007EFF,0xFFFFFFFBFFFFFFFF}},
+        {{0x23FFFFFFFFFFFFF0,0xFFFE0003FF010000,0x23C5FDFFFFF99FE1,0x10030003B0004000},{0xFFFFFFFFFFFFFFFF,0xFFFEFFCFFFFFFFFF,0xF3C5FDFFFFF99FEF,0x5003FFCFB080799F}},
+        {{0x036DFDFFFFF987E0,0x001C00005E000000,0x23EDFDFFFFFBBFE0,0x0200000300010000},{0xD36DFDFFFFF987EE,0x003FFFC05E023987,0xF3EDFDFFFFFBBFEE,0xFE00FFCF00013BBF}},
+        {{0x23EDFDFFFFF99FE0,0x00020003B0000000,0x03FFC718D63DC7E8,0x0000000000010000},{0xF3EDFDFFFFF99FEE,0x0002FFCFB0E0399F,0xC3FFC718D63DC7EC,0x0000FFC000813DC7}},
+        {{0x23FFFDFFFFFDDFE0,0x0000000327000000,0x23EFFDFFFFFDDFE1,0x0006000360000000},{0xF3FFFDFFFFFDDFFF,0x0000FFCF27603DDF,0xF3EFFDFFFFFDDFEF,0x0006FFCF60603DDF}},
+        {{0x27FFFFFFFFFDDFF0,0xFC00000380704000,0x2FFBFFFFFC7FFFE0,0x000000000000007F},{0xFFFFFFFFFFFDDFFF,0xFC00FFCF80F07DDF,0x2FFBFFFFFC7FFFEE,0x000CFFC0FF5F847F}},
+        {{0x0005FFFFFFFFFFFE,0x000000000000007F,0x2005FFAFFFFFF7D6,0x00000000F000005F},{0x07FFFFFFFFFFFFFE,0x0000000003FF7FFF,0x3FFFFFAFFFFFF7D6,0x00000000F3FF3F5F}},
+        {{0x0000000000000001,0x00001FFFFFFFFEFF,0x0000000000001F00,0x0000000000000000},{0xC2A003FF03000001,0xFFFE1FFFFFFFFEFF,0x1FFFFFFFFEFFFFDF,0x0000000000000040}},
+        {{0x800007FFFFFFFFFF,0xFFE1C0623C3F0000,0xFFFFFFFF00004003,0xF7FFFFFFFFFF20BF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFF03FF,0xFFFFFFFF3FFFFFFF,0xF7FFFFFFFFFF20BF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFF3D7F3DFF,0x7F3DFFFFFFFF3DFF,0xFFFFFFFFFF7FFF3D},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFF3D7F3DFF,0x7F3DFFFFFFFF3DFF,0xFFFFFFFFFF7FFF3D}},
+        {{0xFFFFFFFFFF3DFFFF,0x0000000007FFFFFF,0xFFFFFFFF0000FFFF,0x3F3FFFFFFFFFFFFF},{0xFFFFFFFFFF3DFFFF,0x0003FE00E7FFFFFF,0xFFFFFFFF0000FFFF,0x3F3FFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFE,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFE,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFF9FFFFFFFFFFF,0xFFFFFFFF07FFFFFE,0x01FFC7FFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFF9FFFFFFFFFFF,0xFFFFFFFF07FFFFFE,0x01FFC7FFFFFFFFFF}},
+        {{0x0003FFFF8003FFFF,0x0001DFFF0003FFFF,0x000FFFFFFFFFFFFF,0x0000000010800000},{0x001FFFFF803FFFFF,0x000DDFFF000FFFFF,0xFFFFFFFFFFFFFFFF,0x000003FF308FFFFF}},
+        {{0xFFFFFFFF00000000,0x01FFFFFFFFFFFFFF,0xFFFF05FFFFFFFFFF,0x003FFFFFFFFFFFFF},{0xFFFFFFFF03FFB800,0x01FFFFFFFFFFFFFF,0xFFFF07FFFFFFFFFF,0x003FFFFFFFFFFFFF}},
+        {{0x000000007FFFFFFF,0x001F3FFFFFFF0000,0xFFFF0FFFFFFFFFFF,0x00000000000003FF},{0x0FFF0FFF7FFFFFFF,0x001F3FFFFFFFFFC0,0xFFFF0FFFFFFFFFFF,0x0000000007FF03FF}},
+        {{0xFFFFFFFF007FFFFF,0x00000000001FFFFF,0x0000008000000000,0x0000000000000000},{0xFFFFFFFF0FFFFFFF,0x9FFFFFFF7FFFFFFF,0xBFFF008003FF03FF,0x0000000000007FFF}},
+        {{0x000FFFFFFFFFFFE0,0x0000000000001FE0,0xFC00C001FFFFFFF8,0x0000003FFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0x000FF80003FF1FFF,0xFFFFFFFFFFFFFFFF,0x000FFFFFFFFFFFFF}},
+        {{0x0000000FFFFFFFFF,0x3FFFFFFFFC00E000,0xE7FFFFFFFFFF01FF,0x046FDE0000000000},{0x00FFFFFFFFFFFFFF,0x3FFFFFFFFFFFE3FF,0xE7FFFFFFFFFF01FF,0x07FFFFFFFFF70000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFF3F3FFFFF,0x3FFFFFFFAAFF3F3F,0x5FDFFFFFFFFFFFFF,0x1FDC1FFF0FCF1FDC},{0xFFFFFFFF3F3FFFFF,0x3FFFFFFFAAFF3F3F,0x5FDFFFFFFFFFFFFF,0x1FDC1FFF0FCF1FDC}},
+        {{0x0000000000000000,0x8002000000000000,0x000000001FFF0000,0x0000000000000000},{0x8000000000000000,0x8002000000100001,0x000000001FFF0000,0x0001FFE21FFF0000}},
+        {{0xF3FFFD503F2FFC84,0xFFFFFFFF000043E0,0x00000000000001FF,0x0000000000000000},{0xF3FFFD503F2FFC84,0xFFFFFFFF000043E0,0x00000000000001FF,0x0000000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x000C781FFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x000FF81FFFFFFFFF}},
+        {{0xFFFF20BFFFFFFFFF,0x000080FFFFFFFFFF,0x7F7F7F7F007FFFFF,0x000000007F7F7F7F},{0xFFFF20BFFFFFFFFF,0x800080FFFFFFFFFF,0x7F7F7F7F007FFFFF,0xFFFFFFFF7F7F7F7F}},
+        {{0x1F3E03FE000000E0,0xFFFFFFFFFFFFFFFE,0xFFFFFFFEE07FFFFF,0xF7FFFFFFFFFFFFFF},{0x1F3EFFFE000000E0,0xFFFFFFFFFFFFFFFE,0xFFFFFFFEE67FFFFF,0xF7FFFFFFFFFFFFFF}},
+        {{0xFFFEFFFFFFFFFFE0,0xFFFFFFFFFFFFFFFF,0xFFFFFFFF00007FFF,0xFFFF000000000000},{0xFFFEFFFFFFFFFFE0,0xFFFFFFFFFFFFFFFF,0xFFFFFFFF00007FFF,0xFFFF000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000000000001FFF,0x3FFFFFFFFFFF0000},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000000000001FFF,0x3FFFFFFFFFFF0000}},
+        {{0x00000C00FFFF1FFF,0x80007FFFFFFFFFFF,0xFFFFFFFF3FFFFFFF,0x0000FFFFFFFFFFFF},{0x00000FFFFFFF1FFF,0xBFF0FFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0003FFFFFFFFFFFF}},
+        {{0xFFFFFFFCFF800000,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFF9FF,0xFFFC000003EB07FF},{0xFFFFFFFCFF800000,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFF9FF,0xFFFC000003EB07FF}},
+        {{0x00000007FFFFF7BB,0x000FFFFFFFFFFFFF,0x000FFFFFFFFFFFFC,0x68FC000000000000},{0x000010FFFFFFFFFF,0x000FFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xE8FFFFFF03FF003F}},
+        {{0xFFFF003FFFFFFC00,0x1FFFFFFF0000007F,0x0007FFFFFFFFFFF0,0x7C00FFDF00008000},{0xFFFF3FFFFFFFFFFF,0x1FFFFFFF000FFFFF,0xFFFFFFFFFFFFFFFF,0x7FFFFFFF03FF8001}},
+        {{0x000001FFFFFFFFFF,0xC47FFFFF00000FF7,0x3E62FFFFFFFFFFFF,0x001C07FF38000005},{0x007FFFFFFFFFFFFF,0xFC7FFFFF03FF3FFF,0xFFFFFFFFFFFFFFFF,0x007CFFFF38000007}},
+        {{0xFFFF7F7F007E7E7E,0xFFFF03FFF7FFFFFF,0xFFFFFFFFFFFFFFFF,0x00000007FFFFFFFF},{0xFFFF7F7F007E7E7E,0xFFFF03FFF7FFFFFF,0xFFFFFFFFFFFFFFFF,0x03FF37FFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFF000FFFFFFFFF,0x0FFFFFFFFFFFF87F},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFF000FFFFFFFFF,0x0FFFFFFFFFFFF87F}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFF3FFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000000003FFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFF3FFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000000003FFFFFF}},
+        {{0x5F7FFDFFA0F8007F,0xFFFFFFFFFFFFFFDB,0x0003FFFFFFFFFFFF,0xFFFFFFFFFFF80000},{0x5F7FFDFFE0F8007F,0xFFFFFFFFFFFFFFDB,0x0003FFFFFFFFFFFF,0xFFFFFFFFFFF80000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFF03FFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFF03FFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0x3FFFFFFFFFFFFFFF,0xFFFFFFFFFFFF0000,0xFFFFFFFFFFFCFFFF,0x03FF0000000000FF},{0x3FFFFFFFFFFFFFFF,0xFFFFFFFFFFFF0000,0xFFFFFFFFFFFCFFFF,0x03FF0000000000FF}},
+        {{0x0000000000000000,0xAA8A000000000000,0xFFFFFFFFFFFFFFFF,0x1FFFFFFFFFFFFFFF},{0x0018FFFF0000FFFF,0xAA8A00000000E000,0xFFFFFFFFFFFFFFFF,0x1FFFFFFFFFFFFFFF}},
+        {{0x07FFFFFE00000000,0xFFFFFFC007FFFFFE,0x7FFFFFFF3FFFFFFF,0x000000001CFCFCFC},{0x87FFFFFE03FF0000,0xFFFFFFC007FFFFFE,0x7FFFFFFFFFFFFFFF,0x000000001CFCFCFC}},
+        {{0xB7FFFF7FFFFFEFFF,0x000000003FFF3FFF,0xFFFFFFFFFFFFFFFF,0x07FFFFFFFFFFFFFF},{0xB7FFFF7FFFFFEFFF,0x000000003FFF3FFF,0xFFFFFFFFFFFFFFFF,0x07FFFFFFFFFFFFFF}},
+        {{0x0000000000000000,0x001FFFFFFFFFFFFF,0x0000000000000000,0x0000000000000000},{0x0000000000000000,0x001FFFFFFFFFFFFF,0x0000000000000000,0x2000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0xFFFFFFFF1FFFFFFF,0x000000000001FFFF},{0x0000000000000000,0x0000000000000000,0xFFFFFFFF1FFFFFFF,0x000000010001FFFF}},
+        {{0xFFFFE000FFFFFFFF,0x003FFFFFFFFF07FF,0xFFFFFFFF3FFFFFFF,0x00000000003EFF0F},{0xFFFFE000FFFFFFFF,0x07FFFFFFFFFF07FF,0xFFFFFFFF3FFFFFFF,0x00000000003EFF0F}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFF00003FFFFFFF,0x0FFFFFFFFF0FFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFF03FF3FFFFFFF,0x0FFFFFFFFF0FFFFF}},
+        {{0xFFFF00FFFFFFFFFF,0xF7FF000FFFFFFFFF,0x1BFBFFFBFFB7F7FF,0x0000000000000000},{0xFFFF00FFFFFFFFFF,0xF7FF000FFFFFFFFF,0x1BFBFFFBFFB7F7FF,0x0000000000000000}},
+        {{0x007FFFFFFFFFFFFF,0x000000FF003FFFFF,0x07FDFFFFFFFFFFBF,0x0000000000000000},{0x007FFFFFFFFFFFFF,0x000000FF003FFFFF,0x07FDFFFFFFFFFFBF,0x0000000000000000}},
+        {{0x91BFFFFFFFFFFD3F,0x007FFFFF003FFFFF,0x000000007FFFFFFF,0x0037FFFF00000000},{0x91BFFFFFFFFFFD3F,0x007FFFFF003FFFFF,0x000000007FFFFFFF,0x0037FFFF00000000}},
+        {{0x03FFFFFF003FFFFF,0x0000000000000000,0xC0FFFFFFFFFFFFFF,0x0000000000000000},{0x03FFFFFF003FFFFF,0x0000000000000000,0xC0FFFFFFFFFFFFFF,0x0000000000000000}},
+        {{0x003FFFFFFEEF0001,0x1FFFFFFF00000000,0x000000001FFFFFFF,0x0000001FFFFFFEFF},{0x873FFFFFFEEFF06F,0x1FFFFFFF00000000,0x000000001FFFFFFF,0x0000007FFFFFFEFF}},
+        {{0x003FFFFFFFFFFFFF,0x0007FFFF003FFFFF,0x000000000003FFFF,0x0000000000000000},{0x003FFFFFFFFFFFFF,0x0007FFFF003FFFFF,0x000000000003FFFF,0x0000000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0x00000000000001FF,0x0007FFFFFFFFFFFF,0x0007FFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0x00000000000001FF,0x0007FFFFFFFFFFFF,0x0007FFFFFFFFFFFF}},
+        {{0x0000000FFFFFFFFF,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x03FF00FFFFFFFFFF,0x0000000000000000,0x0000000000000000,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x000303FFFFFFFFFF,0x0000000000000000},{0x0000000000000000,0x0000000000000000,0x00031BFFFFFFFFFF,0x0000000000000000}},
+        {{0xFFFF00801FFFFFFF,0xFFFF00000000003F,0xFFFF000000000003,0x007FFFFF0000001F},{0xFFFF00801FFFFFFF,0xFFFF00000001FFFF,0xFFFF00000000003F,0x007FFFFF0000001F}},
+        {{0x00FFFFFFFFFFFFF8,0x0026000000000000,0x0000FFFFFFFFFFF8,0x000001FFFFFF0000},{0xFFFFFFFFFFFFFFFF,0x803FFFC00000007F,0x07FFFFFFFFFFFFFF,0x03FF01FFFFFF0004}},
+        {{0x0000007FFFFFFFF8,0x0047FFFFFFFF0090,0x0007FFFFFFFFFFF8,0x000000001400001E},{0xFFDFFFFFFFFFFFFF,0x004FFFFFFFFF00F0,0xFFFFFFFFFFFFFFFF,0x0000000017FFDE1F}},
+        {{0x00000FFFFFFBFFFF,0x0000000000000000,0xFFFF01FFBFFFBD7F,0x000000007FFFFFFF},{0x40FFFFFFFFFBFFFF,0x0000000000000000,0xFFFF01FFBFFFBD7F,0x03FF07FFFFFFFFFF}},
+        {{0x23EDFDFFFFF99FE0,0x00000003E0010000,0x0000000000000000,0x0000000000000000},{0xFBEDFDFFFFF99FEF,0x001F1FCFE081399F,0x0000000000000000,0x0000000000000000}},
+        {{0x001FFFFFFFFFFFFF,0x0000000380000780,0x0000FFFFFFFFFFFF,0x00000000000000B0},{0xFFFFFFFFFFFFFFFF,0x00000003C3FF07FF,0xFFFFFFFFFFFFFFFF,0x0000000003FF00BF}},
+        {{0x0000000000000000,0x0000000000000000,0x00007FFFFFFFFFFF,0x000000000F000000},{0x0000000000000000,0x0000000000000000,0xFF3FFFFFFFFFFFFF,0x000000003F000001}},
+        {{0x0000FFFFFFFFFFFF,0x0000000000000010,0x010007FFFFFFFFFF,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0x0000000003FF0011,0x01FFFFFFFFFFFFFF,0x00000000000003FF}},
+        {{0x0000000007FFFFFF,0x000000000000007F,0x0000000000000000,0x0000000000000000},{0x03FF0FFFE7FFFFFF,0x000000000000007F,0x0000000000000000,0x0000000000000000}},
+        {{0x00000FFFFFFFFFFF,0x0000000000000000,0xFFFFFFFF00000000,0x80000000FFFFFFFF},{0x07FFFFFFFFFFFFFF,0x0000000000000000,0xFFFFFFFF00000000,0x800003FFFFFFFFFF}},
+        {{0x8000FFFFFF6FF27F,0x0000000000000002,0xFFFFFCFF00000000,0x0000000A0001FFFF},{0xF9BFFFFFFF6FF27F,0x0000000003FF000F,0xFFFFFCFF00000000,0x0000001BFCFFFFFF}},
+        {{0x0407FFFFFFFFF801,0xFFFFFFFFF0010000,0xFFFF0000200003FF,0x01FFFFFFFFFFFFFF},{0x7FFFFFFFFFFFFFFF,0xFFFFFFFFFFFF0080,0xFFFF000023FFFFFF,0x01FFFFFFFFFFFFFF}},
+        {{0x00007FFFFFFFFDFF,0xFFFC000000000001,0x000000000000FFFF,0x0000000000000000},{0xFF7FFFFFFFFFFDFF,0xFFFC000003FF0001,0x007FFEFFFFFCFFFF,0x0000000000000000}},
+        {{0x0001FFFFFFFFFB7F,0xFFFFFDBF00000040,0x00000000010003FF,0x0000000000000000},{0xB47FFFFFFFFFFB7F,0xFFFFFDBF03FF00FF,0x000003FF01FB7FFF,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0007FFFF00000000},{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x007FFFFF00000000}},
+        {{0x0000000000000000,0x0000000000000000,0x0001000000000000,0x0000000000000000},{0x0000000000000000,0x0000000000000000,0x0001000000000000,0x0000000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000000003FFFFFF,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000000003FFFFFF,0x0000000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0x00007FFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0x00007FFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0x000000000000000F,0x0000000000000000,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0x000000000000000F,0x0000000000000000,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0xFFFFFFFFFFFF0000,0x0001FFFFFFFFFFFF},{0x0000000000000000,0x0000000000000000,0xFFFFFFFFFFFF0000,0x0001FFFFFFFFFFFF}},
+        {{0x00007FFFFFFFFFFF,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x00007FFFFFFFFFFF,0x0000000000000000,0x0000000000000000,0x0000000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0x000000000000007F,0x0000000000000000,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0x000000000000007F,0x0000000000000000,0x0000000000000000}},
+        {{0x01FFFFFFFFFFFFFF,0xFFFF00007FFFFFFF,0x7FFFFFFFFFFFFFFF,0x00003FFFFFFF0000},{0x01FFFFFFFFFFFFFF,0xFFFF03FF7FFFFFFF,0x7FFFFFFFFFFFFFFF,0x001F3FFFFFFF03FF}},
+        {{0x0000FFFFFFFFFFFF,0xE0FFFFF80000000F,0x000000000000FFFF,0x0000000000000000},{0x007FFFFFFFFFFFFF,0xE0FFFFF803FF000F,0x000000000000FFFF,0x0000000000000000}},
+        {{0x0000000000000000,0xFFFFFFFFFFFFFFFF,0x0000000000000000,0x0000000000000000},{0x0000000000000000,0xFFFFFFFFFFFFFFFF,0x0000000000000000,0x0000000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0x00000000000107FF,0x00000000FFF80000,0x0000000B00000000},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFF87FF,0x00000000FFFF80FF,0x0003001B00000000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x00FFFFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x00FFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x00000000003FFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x00000000003FFFFF}},
+        {{0x00000000000001FF,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x00000000000001FF,0x0000000000000000,0x0000000000000000,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x6FEF000000000000},{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x6FEF000000000000}},
+        {{0x00000007FFFFFFFF,0xFFFF00F000070000,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF},{0x00000007FFFFFFFF,0xFFFF00F000070000,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0FFFFFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0FFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0x1FFF07FFFFFFFFFF,0x0000000003FF01FF,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0x1FFF07FFFFFFFFFF,0x0000000063FF01FF,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0xFFFF3FFFFFFFFFFF,0x000000000000007F,0x0000000000000000,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x0000000000000000,0xF807E3E000000000,0x00003C0000000FE7,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x0000000000000000,0x000000000000001C,0x0000000000000000,0x0000000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFDFFFFF,0xEBFFDE64DFFFFFFF,0xFFFFFFFFFFFFFFEF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFDFFFFF,0xEBFFDE64DFFFFFFF,0xFFFFFFFFFFFFFFEF}},
+        {{0x7BFFFFFFDFDFE7BF,0xFFFFFFFFFFFDFC5F,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF},{0x7BFFFFFFDFDFE7BF,0xFFFFFFFFFFFDFC5F,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFF3FFFFFFFFF,0xF7FFFFFFF7FFFFFD},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFF3FFFFFFFFF,0xF7FFFFFFF7FFFFFD}},
+        {{0xFFDFFFFFFFDFFFFF,0xFFFF7FFFFFFF7FFF,0xFFFFFDFFFFFFFDFF,0x0000000000000FF7},{0xFFDFFFFFFFDFFFFF,0xFFFF7FFFFFFF7FFF,0xFFFFFDFFFFFFFDFF,0xFFFFFFFFFFFFCFF7}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0xF87FFFFFFFFFFFFF,0x00201FFFFFFFFFFF,0x0000FFFEF8000010,0x0000000000000000}},
+        {{0x000000007FFFFFFF,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x000000007FFFFFFF,0x0000000000000000,0x0000000000000000,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x000007DBF9FFFF7F,0x0000000000000000,0x0000000000000000,0x0000000000000000}},
+        {{0x3F801FFFFFFFFFFF,0x0000000000004000,0x0000000000000000,0x0000000000000000},{0x3FFF1FFFFFFFFFFF,0x00000000000043FF,0x0000000000000000,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x00003FFFFFFF0000,0x00000FFFFFFFFFFF},{0x0000000000000000,0x0000000000000000,0x00007FFFFFFF0000,0x03FFFFFFFFFFFFFF}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x7FFF6F7F00000000},{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x7FFF6F7F00000000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x000000000000001F},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x00000000007F001F}},
+        {{0xFFFFFFFFFFFFFFFF,0x000000000000080F,0x0000000000000000,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0x0000000003FF0FFF,0x0000000000000000,0x0000000000000000}},
+        {{0x0AF7FE96FFFFFFEF,0x5EF7F796AA96EA84,0x0FFFFBEE0FFFFBFF,0x0000000000000000},{0x0AF7FE96FFFFFFEF,0x5EF7F796AA96EA84,0x0FFFFBEE0FFFFBFF,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x03FF000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x00000000FFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x00000000FFFFFFFF}},
+        {{0x01FFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF},{0x01FFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFF3FFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF},{0xFFFFFFFF3FFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFF0003FFFFFFFF,0xFFFFFFFFFFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFF0003FFFFFFFF,0xFFFFFFFFFFFFFFFF}},
+        {{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x00000001FFFFFFFF},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x00000001FFFFFFFF}},
+        {{0x000000003FFFFFFF,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0x000000003FFFFFFF,0x0000000000000000,0x0000000000000000,0x0000000000000000}},
+        {{0xFFFFFFFFFFFFFFFF,0x00000000000007FF,0x0000000000000000,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0x00000000000007FF,0x0000000000000000,0x0000000000000000}},
+        {{0x0000000000000000,0x0000000000000000,0x0000000000000000,0x0000000000000000},{0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFF,0x0000FFFFFFFFFFFF}}
+       };
+    // [end of generated]
+
+    //-----------------------------------------------------------------------
+    // Per byte high bit set if the ascii byte is in [lo,hi]
+    [[nodiscard]] constexpr std::uint64_t ascii_bytes_in_range(const std::uint64_t word, const std::uint8_t lo, const std::uint8_t hi) noexcept
+       {
+        constexpr std::uint64_t ones = 0x0101'0101'0101'0101;
+        constexpr std::uint64_t high_bits = 0x8080'8080'8080'8080;
+        const std::uint64_t not_below_lo = (word | high_bits) - ones*lo;
+        const std::uint64_t beyond_hi = (word | high_bits) - ones*(hi+1u);
+        return not_below_lo & ~beyond_hi & ~word & high_bits;
        }
 
-    return out_bytes;
-}
+    //-----------------------------------------------------------------------
+    // Per byte high bit set if the byte is one of [A-Za-z0-9_]
+    [[nodiscard]] constexpr std::uint64_t ascii_identifier_bytes(const std::uint64_t word) noexcept
+       {
+        return ascii_bytes_in_range(word | 0x2020'2020'2020'2020, 'a', 'z') // Letters of both cases
+             | ascii_bytes_in_range(word, '0', '9')
+             | ascii_bytes_in_range(word, '_', '_');
+       }
 
-//-----------------------------------------------------------------------
-template<utxt::Enc OUTENC>
-[[nodiscard]] constexpr std::string encode_as(const char32_t codepoint)
+    //-----------------------------------------------------------------------
+    // Skip the ascii identifier characters [A-Za-z0-9_] a word at a time
+    template<Enc ENC>
+    [[nodiscard]] inline std::size_t skip_ascii_identifier_chars(const std::string_view bytes, std::size_t pos) noexcept
+       {
+        if constexpr( ENC==Enc::UTF8 or ENC==Enc::UTF16LE or ENC==Enc::UTF16BE )
+           {
+            constexpr std::uint64_t high_bits = 0x8080'8080'8080'8080;
+            // The high bits of the first bytes of the utf-16 code units in the loaded word
+            constexpr std::uint64_t first_bytes = std::endian::native==std::endian::little ? 0x0080'0080'0080'0080 : 0x8000'8000'8000'8000;
+            while( (pos+sizeof(std::uint64_t))<=bytes.size() )
+               {
+                const std::uint64_t word = load_word(bytes.data()+pos);
+                std::uint64_t accepted = ascii_identifier_bytes(word);
+                if constexpr( ENC==Enc::UTF16LE or ENC==Enc::UTF16BE )
+                   {// The other byte of the code unit must be zero
+                    const std::uint64_t zeroes = ascii_bytes_in_range(word, 0, 0);
+                    constexpr std::uint64_t low_bytes = ENC==Enc::UTF16LE ? first_bytes : high_bits & ~first_bytes;
+                    accepted = (accepted & low_bytes) | (zeroes & ~low_bytes);
+                   }
+
+                const std::uint64_t rejected = ~accepted & high_bits;
+                if( rejected==0 )
+                   {
+                    pos += sizeof(std::uint64_t);
+                    continue;
+                   }
+
+                const int rejected_bits = std::endian::native==std::endian::little ? std::countr_zero(rejected) : std::countl_zero(rejected);
+                const auto accepted_bytes = static_cast<std::size_t>(rejected_bits / 8);
+                pos += ENC==Enc::UTF8 ? accepted_bytes : accepted_bytes & ~std::size_t{1};
+                break;
+               }
+           }
+        return pos;
+       }
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
+
+//---------------------------------------------------------------------------
+[[nodiscard]] constexpr bool is_xid_start(const char32_t codepoint) noexcept
 {
-    std::string out_bytes;
-    out_bytes.reserve( 4 );
-    append_codepoint<OUTENC>(codepoint, out_bytes);
-    return out_bytes;
+    if( codepoint>=0x110000 ) return false;
+    const details::xid_block_t& block = details::xid_blocks[details::xid_block_index[codepoint / details::xid_block_size]];
+    return ((block.start_bits[(codepoint / 64) % 4] >> (codepoint % 64)) & 1)!=0;
 }
 
 //---------------------------------------------------------------------------
-// const std::string out_bytes = utxt::encode_as(enc,U"str");
-//template<typename T>
-//concept a_basic_string = std::same_as<T, std::basic_string<typename T::value_type, typename T::traits_type, typename T::allocator_type>>;
-[[nodiscard]] constexpr std::string encode_as(const utxt::Enc enc, const std::u32string_view u32str)
+[[nodiscard]] constexpr bool is_xid_continue(const char32_t codepoint) noexcept
 {
-    TEXT_DISPATCH_TO_ENC(enc, encode_as<, >(u32str))
+    if( codepoint>=0x110000 ) return false;
+    const details::xid_block_t& block = details::xid_blocks[details::xid_block_index[codepoint / details::xid_block_size]];
+    return ((block.continue_bits[(codepoint / 64) % 4] >> (codepoint % 64)) & 1)!=0;
 }
+
 //---------------------------------------------------------------------------
-[[nodiscard]] constexpr std::string encode_as(const utxt::Enc enc, const char32_t codepoint)
+// The end of the longest identifier starting at the given byte offset:
+// a XID_Start character or underscore followed by XID_Continue characters.
+// Returns the given offset if there's no identifier
+// const std::size_t end = utxt::scan_identifier<UTF8>(bytes, pos);
+template<Enc ENC>
+[[nodiscard]] constexpr std::size_t scan_identifier(const std::string_view bytes, std::size_t pos) noexcept
 {
-    TEXT_DISPATCH_TO_ENC(enc, encode_as<, >(codepoint))
+    constexpr std::size_t unit_size = code_unit_size_of(ENC);
+    std::size_t next_pos = pos;
+    if( (pos+unit_size)>bytes.size() )
+       {
+        return pos;
+       }
+    const char32_t first = extract_codepoint<ENC>(bytes, next_pos);
+    if( not is_xid_start(first) and first!=U'_' )
+       {
+        return pos;
+       }
+
+    while( true )
+       {
+        pos = next_pos;
+        if !consteval
+           {
+            pos = details::skip_ascii_identifier_chars<ENC>(bytes, pos);
+           }
+        next_pos = pos;
+        if( (pos+unit_size)>bytes.size() or not is_xid_continue(extract_codepoint<ENC>(bytes, next_pos)) )
+           {
+            break;
+           }
+       }
+    return pos;
 }
 
 
+}//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-/// [Encode utf-32 to utf-8 bytes]
 
-//-----------------------------------------------------------------------
-[[nodiscard]] constexpr std::string to_utf8(const std::u32string_view u32str)
-{
-    return encode_as<Enc::UTF8>(u32str);
-}
-//-----------------------------------------------------------------------
-[[nodiscard]] constexpr std::string to_utf8(const char32_t codepoint)
+#if defined(__cpp_lib_format)
+//:::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+namespace utxt::details
 {
-    return encode_as<Enc::UTF8>(codepoint);
-}
+    /////////////////////////////////////////////////////////////////////////
+    // Writes the text as utf-8 straight into the format output
+    struct utf8_formatter_t
+       {
+        constexpr auto parse(std::format_parse_context& ctx)
+           {
+            if( ctx.begin()!=ctx.end() and *ctx.begin()!='}' )
+               {
+                throw std::format_error("utxt: format specifiers not supported");
+               }
+            return ctx.begin();
+           }
 
-}//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+        template<typename T, typename FormatContext>
+        auto format(const T& txt, FormatContext& ctx) const
+           {
+            return write_as_utf8(txt, ctx.out());
+           }
+       };
+} //::::::::::::::::::::::::::::::: details :::::::::::::::::::::::::::::::::
+
+//---------------------------------------------------------------------------
+// std::format("{}", utxt::as<UTF16LE>(in_bytes));
+template<> struct std::formatter<utxt::encoded_view_t, char> : utxt::details::utf8_formatter_t {};
+
+//---------------------------------------------------------------------------
+// std::format("{}", utxt::as_utf8(U"abc"sv));
+template<typename CharT> struct std::formatter<utxt::as_utf8_t<CharT>, char> : utxt::details::utf8_formatter_t {};
+#endif
 
 
 
@@ -683,6 +3356,9 @@ template<utxt::Enc OUTENC>
 /////////////////////////////////////////////////////////////////////////////
 #ifdef TEST_UNITS ///////////////////////////////////////////////////////////
 #include <array>
+#include <thread>
+#include <unordered_map>
+#include <sstream>
 using namespace std::literals; // "..."sv
 static ut::suite<"utxt::"> text_tests = []
 {////////////////////////////////////////////////////////////////////////////
@@ -811,6 +3487,31 @@ ut::test("codepoints decode and encode") = []
        }
    };
 
+ut::test("invalid utf-8") = []
+   {
+    // Boundaries of the sequence sizes
+    expect( utxt::to_utf32<UTF8>("\x7F\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF\xF0\x90\x80\x80\xF4\x8F\xBF\xBF"sv)==U"\u007F\u0080\u07FF\u0800\uFFFF\U00010000\U0010FFFF"sv );
+    expect( utxt::to_utf8(U"\u007F\u0080\u07FF\u0800\uFFFF\U00010000\U0010FFFF"sv)=="\x7F\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF\xF0\x90\x80\x80\xF4\x8F\xBF\xBF"sv );
+    static_assert( utxt::to_utf32<UTF8>("\xE2\x9F\xB6"sv)==U"\u27F6"sv );
+
+    // Overlong sequences
+    expect( utxt::to_utf32<UTF8>("\xC0\x80"sv)==U"\uFFFD\uFFFD"sv ) << "overlong nul\n";
+    expect( utxt::to_utf32<UTF8>("\xE0\x9F\xBF"sv)==U"\uFFFD\uFFFD\uFFFD"sv ) << "overlong three bytes\n";
+    expect( utxt::to_utf32<UTF8>("\xF0\x8F\xBF\xBF"sv)==U"\uFFFD\uFFFD\uFFFD\uFFFD"sv ) << "overlong four bytes\n";
+
+    // Surrogates and beyond U+10FFFF
+    expect( utxt::to_utf32<UTF8>("\xED\xA0\x80"sv)==U"\uFFFD\uFFFD\uFFFD"sv ) << "surrogate\n";
+    expect( utxt::to_utf32<UTF8>("\xF4\x90\x80\x80"sv)==U"\uFFFD\uFFFD\uFFFD\uFFFD"sv ) << "beyond U+10FFFF\n";
+    expect( utxt::to_utf32<UTF8>("\xF5\xFF"sv)==U"\uFFFD\uFFFD"sv ) << "invalid bytes\n";
+
+    // Maximal valid subparts replaced by a single U+FFFD
+    expect( utxt::to_utf32<UTF8>("\xE2\x9F" "a"sv)==U"\uFFFDa"sv );
+    expect( utxt::to_utf32<UTF8>("\xF0\x9F\x8D" "a\xF0\x9F\x8D"sv)==U"\uFFFDa\uFFFD"sv );
+    expect( utxt::to_utf32<UTF8>("\x80\xBF" "a"sv)==U"\uFFFD\uFFFDa"sv ) << "lone continuation bytes\n";
+    expect( utxt::to_utf32<UTF8>("long ascii run\xC3\xA8\xFF" "another long ascii run\xF0\x9F\x8D"sv)==U"long ascii run\u00E8\uFFFDanother long ascii run\uFFFD"sv ) << "ascii runs among invalid sequences\n";
+    static_assert( utxt::to_utf32<UTF8>("\xED\xA0"sv)==U"\uFFFD\uFFFD"sv );
+   };
+
 ut::test("utxt::bytes_buffer_t") = []
    {
     utxt::bytes_buffer_t<utxt::Enc::UTF16LE> buf("\x61\x00\x62\x00\x63\x00"sv); // u"abc"
@@ -919,6 +3620,614 @@ ut::test("utxt::encode_as(enc,...)") = []
     expect( utxt::encode_as(UTF8,U""sv)==""sv );
     expect( utxt::encode_as(UTF8,U"aà⟶♥♫"sv)=="aà⟶♥♫"sv );
     expect( utxt::encode_as(UTF8,U'⛵')=="⛵"sv );
+    expect( utxt::encode_as(UTF16BE,u"a🍌"sv)=="\0\x61\xD8\x3C\xDF\x4C"sv );
+   };
+
+ut::test("utxt::to_utf16") = []
+   {
+    expect( utxt::to_utf16(u8""sv)==u""sv );
+    expect( utxt::to_utf16(u8"aà⟶♥♫🍌"sv)==u"aà⟶♥♫🍌"sv );
+    expect( utxt::to_utf16(u8"a long enough ascii run, then è and 🍌, then ascii again"sv)==u"a long enough ascii run, then è and 🍌, then ascii again"sv );
+    expect( utxt::to_utf16(U"aà⟶♥♫🍌"sv)==u"aà⟶♥♫🍌"sv );
+    expect( utxt::to_utf16<UTF16LE>("\x61\0\x3C\xD8\x4C\xDF"sv)==u"a🍌"sv );
+    expect( utxt::to_utf16<UTF32BE>("\0\0\0\x61\0\x01\xF3\x4C"sv)==u"a🍌"sv );
+    expect( utxt::to_utf16<UTF16LE>("\x61\0\x62"sv)==u"a\uFFFD"sv ) << "Truncated codepoint should be marked as invalid\n";
+   };
+
+ut::test("utxt::u16string_view inputs") = []
+   {
+    constexpr std::u16string_view u16str = u"ascii words first, then aà⟶♥♫🍌 and ascii again"sv;
+    constexpr std::string_view utf8 = "ascii words first, then aà⟶♥♫🍌 and ascii again"sv;
+    expect( utxt::to_utf8(u16str)==utf8 );
+    expect( utxt::to_utf32(u16str)==U"ascii words first, then aà⟶♥♫🍌 and ascii again"sv );
+    expect( utxt::encode_as<UTF8>(u16str)==utf8 );
+    expect( utxt::encode_as<UTF16LE>(u"a🍌"sv)=="\x61\0\x3C\xD8\x4C\xDF"sv );
+    expect( utxt::encode_as<UTF32LE>(u"a🍌"sv)=="\x61\0\0\0\x4C\xF3\x01\0"sv );
+    static_assert( utxt::to_utf8(u"aà🍌"sv)=="aà🍌"sv );
+
+    // Unpaired surrogates
+    expect( utxt::to_utf32(u"a\xD83C"sv)==U"a\uFFFD"sv );
+    expect( utxt::to_utf32(u"\xDF4C" u"a"sv)==U"\uFFFDa"sv );
+    expect( utxt::to_utf32(u"\xD83C" u"a"sv)==U"\uFFFDa"sv );
+    expect( utxt::encode_as<UTF16LE>(u"a\xD83C" u"b\xDF4C"sv)=="\x61\0\xFD\xFF\x62\0\xFD\xFF"sv ) << "Unpaired surrogates shouldn't be copied\n";
+    expect( utxt::encode_as<UTF16BE>(u"\xD83C\xDF4C\xD83C"sv)=="\xD8\x3C\xDF\x4C\xFF\xFD"sv );
+    expect( utxt::encode_as<UTF32BE>(u"a\xDF4C"sv)=="\0\0\0\x61\0\0\xFF\xFD"sv );
+    expect( utxt::encode_as<UTF8>(u"\xD83C"sv)=="\xEF\xBF\xBD"sv );
+    expect( utxt::to_utf16<UTF8>("ascii words\xF0\x9F"sv)==u"ascii words\uFFFD"sv ) << "Truncated codepoint should be marked as invalid\n";
+   };
+
+ut::test("utxt::line_index_t") = []
+   {
+    auto same = [](const utxt::text_position_t a, const utxt::text_position_t b) noexcept -> bool { return a.line==b.line and a.column==b.column; };
+
+    ut::test("utf-8") = [&same]
+       {
+        const utxt::line_index_t<UTF8> lines("ab\nà⟶c\r\n\nlast"sv);
+        expect( that % lines.lines_count()==4u );
+        expect( lines.line(1)=="ab"sv and lines.line(2)=="à⟶c"sv and lines.line(3)==""sv and lines.line(4)=="last"sv );
+        expect( same(lines.position_of(0), {1,1}) );
+        expect( same(lines.position_of(2), {1,3}) ) << "The line feed belongs to its line\n";
+        expect( same(lines.position_of(3), {2,1}) );
+        expect( same(lines.position_of(4), {2,1}) ) << "An offset inside a codepoint refers to it\n";
+        expect( same(lines.position_of(5), {2,2}) );
+        expect( same(lines.position_of(8), {2,3}) );
+        expect( same(lines.position_of(9), {2,4}) );
+        expect( same(lines.position_of(10), {2,4}) ) << "An offset inside \\r\\n refers to its start\n";
+        expect( same(lines.position_of(12), {4,1}) );
+        expect( same(lines.position_of(16), {4,5}) );
+        expect( that % lines.byte_offset_of({2,3})==8u );
+        expect( that % lines.byte_offset_of({2,99})==9u ) << "Should clamp to line end\n";
+        expect( that % lines.byte_offset_of({4,2})==13u );
+        expect( that % lines.byte_offset_of({5,1})==16u );
+       };
+
+    ut::test("utf-16le") = [&same]
+       {
+        // u"a\u0A0A\n\u010Ab\r\nc": contains 0x0A bytes that are not line feeds
+        const utxt::line_index_t<UTF16LE> lines("a\0\x0A\x0A\x0A\0\x0A\x01" "b\0\r\0\x0A\0c\0"sv);
+        expect( that % lines.lines_count()==3u );
+        expect( lines.line(2)=="\x0A\x01" "b\0"sv );
+        expect( same(lines.position_of(2), {1,2}) );
+        expect( same(lines.position_of(6), {2,1}) );
+        expect( same(lines.position_of(8), {2,2}) );
+        expect( same(lines.position_of(12), {2,3}) );
+        expect( same(lines.position_of(14), {3,1}) );
+        expect( that % lines.byte_offset_of({2,2})==8u );
+        expect( that % lines.byte_offset_of({2,4})==10u );
+        expect( that % lines.byte_offset_of({3,2})==16u );
+       };
+
+    ut::test("utf-16be") = [&same]
+       {
+        const utxt::line_index_t<UTF16BE> lines("\0a\0\x0A\xD8\x3C\xDF\x4C\0b"sv); // u"a\n🍌b"
+        expect( that % lines.lines_count()==2u );
+        expect( same(lines.position_of(8), {2,2}) );
+        expect( same(lines.position_of(6), {2,1}) ) << "An offset inside a surrogate pair refers to it\n";
+        expect( that % lines.byte_offset_of({2,2})==8u );
+       };
+
+    ut::test("utf-32") = [&same]
+       {
+        const utxt::line_index_t<UTF32LE> le_lines("a\0\0\0\x0A\0\0\0\x0A\x01\0\0"sv); // U"a\n\u010A"
+        expect( that % le_lines.lines_count()==2u );
+        expect( same(le_lines.position_of(8), {2,1}) );
+
+        const utxt::line_index_t<UTF32BE> be_lines("\0\0\x01\x0A\0\0\0\x0A\0\0\0a"sv); // U"\u010A\na"
+        expect( that % be_lines.lines_count()==2u );
+        expect( same(be_lines.position_of(8), {2,1}) );
+        expect( be_lines.line(1)=="\0\0\x01\x0A"sv );
+       };
+
+    ut::test("round trip") = [&same]
+       {
+        auto round_trips = [&same]<utxt::Enc ENC>(const std::string_view bytes) -> bool
+           {
+            const utxt::line_index_t<ENC> lines(bytes);
+            for( std::size_t offset=0; offset<=bytes.size(); ++offset )
+               {
+                // The offset of a position is the start of what the offset refers to
+                const utxt::text_position_t pos = lines.position_of(offset);
+                const std::size_t pos_offset = lines.byte_offset_of(pos);
+                if( pos_offset>offset or not same(lines.position_of(pos_offset), pos) ) return false;
+               }
+            return true;
+           };
+        expect( round_trips.operator()<UTF8>("a\r\n\r\nà\r\n"sv) );
+        expect( round_trips.operator()<UTF16LE>("a\0\r\0\x0A\0\r\0\x0A\0\x3C\xD8\x4C\xDF"sv) );
+        expect( round_trips.operator()<UTF32BE>("\0\0\0a\0\0\0\r\0\0\0\x0A\0\0\0\x0A"sv) );
+       };
+   };
+
+ut::test("utxt::text_t") = []
+   {
+    ut::test("detected encoding") = []
+       {
+        const utxt::text_t txt("\xFF\xFE" "a\0\x3C\xD8\x4C\xDF"s); // utf-16le u"a🍌" with bom
+        expect( txt.enc()==UTF16LE );
+        expect( txt.bytes()=="\xFF\xFE" "a\0\x3C\xD8\x4C\xDF"sv );
+        expect( txt.as<UTF8>()=="\xEF\xBB\xBF" "a🍌"sv );
+        expect( txt.as(UTF8).data()==txt.as<UTF8>().data() ) << "Encoding should be cached\n";
+        expect( txt.as<UTF16LE>().data()==txt.bytes().data() ) << "Same encoding should not copy\n";
+       };
+
+    ut::test("skipping bom") = []
+       {
+        const utxt::text_t txt("\xFE\xFF" "\0a\xD8\x3C\xDF\x4C"s, utxt::flag::SKIP_BOM); // utf-16be u"a🍌"
+        expect( txt.enc()==UTF16BE );
+        expect( txt.bytes()=="\0a\xD8\x3C\xDF\x4C"sv );
+        expect( txt.as<UTF8>()=="a🍌"sv );
+        expect( txt.as<UTF16LE>()=="a\0\x3C\xD8\x4C\xDF"sv );
+        expect( txt.as<UTF32BE>()=="\0\0\0a\0\x01\xF3\x4C"sv );
+
+        const utxt::text_t copied(txt);
+        expect( copied.enc()==UTF16BE and copied.bytes()==txt.bytes() );
+        expect( copied.as<UTF8>()=="a🍌"sv and copied.as<UTF8>().data()!=txt.as<UTF8>().data() );
+       };
+
+    ut::test("known encoding") = []
+       {
+        const utxt::text_t txt("a\0\0\0"s, UTF32LE);
+        expect( txt.enc()==UTF32LE and txt.as<UTF8>()=="a"sv );
+       };
+
+    ut::test("assignment") = []
+       {
+        utxt::text_t txt("a\0\0\0"s, UTF32LE);
+        expect( txt.as<UTF8>()=="a"sv );
+
+        const utxt::text_t other("b\0"s, UTF16LE);
+        txt = other;
+        expect( txt.enc()==UTF16LE and txt.bytes()=="b\0"sv );
+        expect( txt.as<UTF8>()=="b"sv ) << "Cached encodings should be dropped\n";
+
+        txt = utxt::text_t("\xEF\xBB\xBF" "c\xC3\xA8"s, utxt::flag::SKIP_BOM);
+        expect( txt.enc()==UTF8 and txt.bytes()=="c\xC3\xA8"sv );
+        expect( txt.as<UTF16LE>()=="c\0\xE8\0"sv );
+        expect( txt.as<UTF8>().data()==txt.bytes().data() );
+       };
+
+    ut::test("moved from") = []
+       {
+        utxt::text_t txt("\xFF\xFE" "a\0"s, utxt::flag::SKIP_BOM);
+        const std::string_view utf8 = txt.as<UTF8>();
+
+        utxt::text_t moved(std::move(txt));
+        expect( moved.bytes()=="a\0"sv and moved.as<UTF8>().data()==utf8.data() ) << "The cache should follow the bytes\n";
+        expect( txt.bytes().empty() and txt.as<UTF8>().empty() and txt.as(UTF32BE).empty() ) << "Moved from should be an empty text\n";
+
+        utxt::text_t assigned("b"s, UTF8);
+        expect( assigned.as<UTF16LE>()=="b\0"sv );
+        assigned = std::move(moved);
+        expect( assigned.bytes()=="a\0"sv and assigned.as<UTF8>()=="a"sv );
+        expect( moved.bytes().empty() and moved.as<UTF16BE>().empty() );
+
+        txt = assigned;
+        expect( txt.bytes()=="a\0"sv and txt.as<UTF8>()=="a"sv and txt.as<UTF8>().data()!=assigned.as<UTF8>().data() );
+       };
+
+    ut::test("concurrent readers") = []
+       {
+        const utxt::text_t txt(std::string(1000, 'a') + "è");
+        std::array<std::string_view,4> results;
+        std::vector<std::thread> readers;
+        for( std::string_view& result : results )
+           {
+            readers.emplace_back([&txt, &result]{ result = txt.as<UTF16BE>(); });
+           }
+        for( std::thread& reader : readers ) reader.join();
+        for( const std::string_view result : results )
+           {
+            expect( result.data()==results[0].data() and that % result.size()==2002u );
+           }
+       };
+   };
+
+ut::test("utxt::hash and utxt::equal") = []
+   {
+    constexpr std::string_view utf8 = "è una ⛵ 🍌 and some ascii"sv;
+    const std::string utf16le = utxt::reencode<UTF8,UTF16LE>(utf8);
+    const std::string utf16be = utxt::reencode<UTF8,UTF16BE>(utf8);
+    const std::string utf32le = utxt::reencode<UTF8,UTF32LE>(utf8);
+    const std::string utf32be = utxt::reencode<UTF8,UTF32BE>(utf8);
+
+    const std::uint64_t h = utxt::hash<UTF8>(utf8);
+    expect( utxt::hash<UTF16LE>(utf16le)==h );
+    expect( utxt::hash<UTF16BE>(utf16be)==h );
+    expect( utxt::hash<UTF32LE>(utf32le)==h );
+    expect( utxt::hash<UTF32BE>(utf32be)==h );
+    expect( utxt::hash({utf16be, UTF16BE})==h );
+    expect( utxt::hash<UTF8>("è una ⛵ 🍌 and some asci!"sv)!=h );
+    expect( utxt::hash<UTF8>("è una ⛵ 🍌 and some ascii "sv)!=h );
+    expect( utxt::hash<UTF8>(""sv)!=utxt::hash<UTF8>("\0"sv) );
+    static_assert( utxt::hash<UTF8>("à🍌 more than a word"sv)==utxt::hash<UTF16BE>("\0\xE0\xD8\x3C\xDF\x4C\0 \0m\0o\0r\0e\0 \0t\0h\0a\0n\0 \0a\0 \0w\0o\0r\0d"sv) );
+    expect( utxt::hash<UTF8>("à🍌 more than a word"sv)==utxt::hash<UTF16BE>("\0\xE0\xD8\x3C\xDF\x4C\0 \0m\0o\0r\0e\0 \0t\0h\0a\0n\0 \0a\0 \0w\0o\0r\0d"sv) ) << "Constant evaluation should agree with runtime\n";
+
+    expect( utxt::equal<UTF8,UTF16LE>(utf8, utf16le) );
+    expect( utxt::equal<UTF32BE,UTF16LE>(utf32be, utf16le) );
+    expect( utxt::equal<UTF16BE,UTF16BE>(utf16be, utf16be) );
+    expect( not utxt::equal<UTF8,UTF16LE>(utf8.substr(1), utf16le) );
+    expect( not utxt::equal<UTF8,UTF16LE>(utf8, std::string_view(utf16le).substr(0,utf16le.size()-2)) );
+    expect( utxt::equal<UTF8,UTF16LE>("a\uFFFD"sv, "a\0b"sv) ) << "Truncated codepoint should be invalid\n";
+    expect( utxt::equal({utf32le, UTF32LE}, {utf16be, UTF16BE}) );
+
+    std::unordered_map<std::string,int,utxt::text_hash_t,utxt::text_equal_t> map;
+    map.emplace(utf8, 1);
+    map.emplace("other", 2);
+    const auto it = map.find(utxt::encoded_view_t{utf16le, UTF16LE});
+    expect( it!=map.end() and it->second==1 );
+    expect( map.find(utxt::encoded_view_t{utf32be, UTF32BE})!=map.end() );
+    expect( map.find(utxt::encoded_view_t{"\0o\0t\0h\0e\0r"sv, UTF16BE})->second==2 );
+    expect( map.find(utxt::encoded_view_t{"\0o\0t\0h\0e\0r\0s"sv, UTF16BE})==map.end() );
+
+    ut::test("invalid utf-8") = []
+       {// Invalid sequences are the same text as '\uFFFD', in any encoding
+        constexpr std::string_view invalid = "a\xFF" "b\xC0\xAF" "c\xED\xA0\x80" "d\xF0\x9F"sv; // Bad byte, overlong, surrogate, truncated
+        constexpr std::string_view replaced = "a\uFFFD" "b\uFFFD\uFFFD" "c\uFFFD\uFFFD\uFFFD" "d\uFFFD"sv;
+        const std::string invalid_utf16le = utxt::reencode<UTF8,UTF16LE>(invalid);
+        expect( utxt::hash<UTF8>(invalid)==utxt::hash<UTF8>(replaced) );
+        expect( utxt::hash<UTF16LE>(invalid_utf16le)==utxt::hash<UTF8>(invalid) );
+        expect( utxt::equal<UTF8,UTF8>(invalid, replaced) and utxt::equal<UTF8,UTF16LE>(invalid, invalid_utf16le) and utxt::equal<UTF16LE,UTF8>(invalid_utf16le, replaced) );
+        expect( utxt::equal<UTF8,UTF8>("a\xFF"sv, "a\xFE"sv) ) << "Equality should be transitive\n";
+        expect( not utxt::equal<UTF8,UTF8>("b\xC0\xAF"sv, "b/"sv) ) << "Overlong encoding is not the character\n";
+        expect( not utxt::equal<UTF8,UTF8>("a\xFF"sv, "a\uFFFD\uFFFD"sv) );
+        expect( utxt::equal<UTF16LE,UTF16LE>("a\0\x3C\xD8"sv, "a\0\xFD\xFF"sv) ) << "Same encoding should compare the codepoints\n";
+        static_assert( utxt::hash<UTF8>("x\xFF more than a word"sv)==utxt::hash<UTF8>("x\uFFFD more than a word"sv) );
+
+        std::unordered_map<std::string,int,utxt::text_hash_t,utxt::text_equal_t> invalid_map;
+        invalid_map.emplace(invalid, 1);
+        invalid_map.emplace("\xC0\xAF", 2);
+        expect( not invalid_map.emplace("a\xFE" "b\xC1\x80" "c\xED\xBF\xBF" "d\xF0\x9F"s, 3).second ) << "Same text should be the same key\n";
+        expect( invalid_map.find(replaced)->second==1 );
+        expect( invalid_map.find(utxt::encoded_view_t{invalid_utf16le, UTF16LE})->second==1 );
+        expect( invalid_map.find(utxt::encoded_view_t{"\xFD\xFF\xFD\xFF"sv, UTF16LE})->second==2 );
+        expect( invalid_map.find(utxt::encoded_view_t{"\0\0\0/"sv, UTF32BE})==invalid_map.end() );
+        expect( invalid_map.find("\xC0\xAF\xC0"sv)==invalid_map.end() );
+
+        // Surrogates and values beyond U+10FFFF in utf-32 are invalid as well
+        for( const std::string_view invalid_utf32le : {"\0\xD8\0\0"sv, "\0\0\x11\0"sv} )
+           {
+            const std::string invalid_as_utf8 = utxt::reencode<UTF32LE,UTF8>(invalid_utf32le);
+            expect( invalid_as_utf8=="\uFFFD"sv );
+            expect( utxt::hash<UTF32LE>(invalid_utf32le)==utxt::hash<UTF8>(invalid_as_utf8) );
+            expect( utxt::equal<UTF32LE,UTF8>(invalid_utf32le, invalid_as_utf8) );
+            expect( utxt::equal<UTF32LE,UTF16LE>(invalid_utf32le, utxt::reencode<UTF32LE,UTF16LE>(invalid_utf32le)) );
+            expect( invalid_map.find(utxt::encoded_view_t{invalid_utf32le, UTF32LE})==invalid_map.end() );
+           }
+        expect( utxt::to_utf32<UTF32BE>("\0\0\xDF\xFF" "\xFF\xFF\xFF\xFF" "\0\x10\xFF\xFF"sv)==U"\uFFFD\uFFFD\U0010FFFF"sv );
+       };
+   };
+
+ut::test("utxt::offset_map_t") = []
+   {
+    ut::test("utf-16le to utf-8") = []
+       {
+        const std::string in_bytes = utxt::reencode<UTF8,UTF16LE>("aà⟶🍌b"sv); // in offsets: 0,2,4,6,10
+        utxt::offset_map_t offsets(2);
+        const std::string out_bytes = utxt::reencode<UTF16LE,UTF8>(in_bytes, offsets); // out offsets: 0,1,3,6,10
+        expect( out_bytes=="aà⟶🍌b"sv );
+        expect( that % offsets.checkpoints().size()==4u ); // {0,0} {3,4} {10,10} {11,12}
+        expect( that % offsets.nearest_by_out(5).out_offset==3u and that % offsets.nearest_by_out(5).in_offset==4u );
+        expect( that % offsets.nearest_by_in(11).in_offset==10u );
+
+        constexpr std::array<std::size_t,5> out_starts{0,1,3,6,10};
+        constexpr std::array<std::size_t,5> in_starts{0,2,4,6,10};
+        for( std::size_t i=0; i<out_starts.size(); ++i )
+           {
+            expect( that % offsets.in_offset_of<UTF16LE,UTF8>(in_bytes, out_starts[i])==in_starts[i] );
+            expect( that % offsets.out_offset_of<UTF16LE,UTF8>(in_bytes, in_starts[i])==out_starts[i] );
+           }
+        expect( that % offsets.in_offset_of<UTF16LE,UTF8>(in_bytes, 8)==6u ) << "Offset inside a codepoint\n";
+        expect( that % offsets.out_offset_of<UTF16LE,UTF8>(in_bytes, 8)==6u ) << "Offset inside a surrogate pair\n";
+        expect( that % offsets.in_offset_of<UTF16LE,UTF8>(in_bytes, 11)==12u );
+        expect( that % offsets.out_offset_of<UTF16LE,UTF8>(in_bytes, 12)==11u );
+       };
+
+    ut::test("truncated input") = []
+       {
+        utxt::offset_map_t offsets;
+        const std::string out_bytes = utxt::reencode<UTF16BE,UTF8>("\0a\0b\0"sv, offsets);
+        expect( out_bytes=="ab\uFFFD"sv );
+        expect( that % offsets.in_offset_of<UTF16BE,UTF8>("\0a\0b\0"sv, 3)==4u );
+        expect( that % offsets.out_offset_of<UTF16BE,UTF8>("\0a\0b\0"sv, 5)==5u );
+       };
+
+    ut::test("utf-8 to utf-32") = []
+       {
+        constexpr std::string_view in_bytes = "aà⟶🍌b"sv;
+        utxt::offset_map_t offsets(3);
+        const std::u32string u32str = utxt::to_utf32<UTF8>(in_bytes, offsets);
+        expect( u32str==U"aà⟶🍌b"sv );
+        expect( that % offsets.in_offset_of_index<UTF8>(in_bytes, 3)==6u );
+        expect( that % offsets.in_offset_of_index<UTF8>(in_bytes, 4)==10u );
+        expect( that % offsets.out_index_of<UTF8>(in_bytes, 7)==3u );
+        expect( that % offsets.out_index_of<UTF8>(in_bytes, 11)==5u );
+       };
+   };
+
+ut::test("utxt::reencode_edit") = []
+   {
+    ut::test("typing in utf-16le") = []
+       {
+        std::string in_bytes = utxt::reencode<UTF8,UTF16LE>("aà⟶🍌b"sv);
+        utxt::offset_map_t offsets(2);
+        std::string out_bytes = utxt::reencode<UTF16LE,UTF8>(in_bytes, offsets);
+
+        const utxt::spliced_range_t changed = utxt::reencode_edit<UTF16LE,UTF8>(in_bytes, out_bytes, offsets, {4, 2, "\x65\0\x66\0"sv}); // ⟶ → ef
+        expect( out_bytes=="aàef🍌b"sv );
+        expect( in_bytes==utxt::reencode<UTF8,UTF16LE>("aàef🍌b"sv) );
+        expect( changed.offset<=3u and (changed.offset+changed.removed_size)>=6u and (changed.removed_size-changed.inserted_size)==1u );
+
+        // Completing a surrogate pair
+        std::ignore = utxt::reencode_edit<UTF16LE,UTF8>(in_bytes, out_bytes, offsets, {0, 2, "\x3C\xD8"sv});
+        expect( out_bytes=="\uFFFDàef🍌b"sv );
+        std::ignore = utxt::reencode_edit<UTF16LE,UTF8>(in_bytes, out_bytes, offsets, {2, 0, "\x4C\xDF"sv});
+        expect( out_bytes=="🍌àef🍌b"sv );
+        expect( that % offsets.in_offset_of<UTF16LE,UTF8>(in_bytes, 6)==6u );
+       };
+
+    ut::test("invalid utf-8 before the edit") = []
+       {
+        std::string in_bytes = "ab\xE2\x9F"s;
+        utxt::offset_map_t offsets(1);
+        std::string out_bytes = utxt::reencode<UTF8,UTF32LE>(in_bytes, offsets);
+        std::ignore = utxt::reencode_edit<UTF8,UTF32LE>(in_bytes, out_bytes, offsets, {4, 0, "\xB6"sv});
+        expect( out_bytes==utxt::encode_as<UTF32LE>(U"ab⟶"sv) );
+       };
+
+    ut::test("random edits") = []
+       {
+        auto check_edits = []<utxt::Enc INENC, utxt::Enc OUTENC>()
+           {
+            std::uint32_t seed = 12345;
+            auto rnd = [&seed](const std::size_t n) { seed = seed*1103515245u + 12345u; return static_cast<std::size_t>(seed >> 8) % n; };
+            const std::array<std::string,6> pieces{ utxt::encode_as<INENC>(U"a"sv), utxt::encode_as<INENC>(U"à"sv), utxt::encode_as<INENC>(U"⟶"sv),
+                                                    utxt::encode_as<INENC>(U"🍌"sv), "\xD8"s, "\xE2\x9F"s };
+            std::string in_bytes;
+            for( int i=0; i<200; ++i ) in_bytes += pieces[rnd(pieces.size())];
+            utxt::offset_map_t offsets(4);
+            std::string out_bytes = utxt::reencode<INENC,OUTENC>(in_bytes, offsets);
+            for( int i=0; i<100; ++i )
+               {
+                std::string inserted;
+                for( std::size_t n=rnd(4); n>0; --n ) inserted += pieces[rnd(pieces.size())];
+                const std::size_t offset = rnd(in_bytes.size()+1);
+                const std::size_t removed_size = rnd(std::min<std::size_t>(in_bytes.size()-offset, 8)+1);
+                const std::string old_out_bytes = out_bytes;
+                const utxt::spliced_range_t changed = utxt::reencode_edit<INENC,OUTENC>(in_bytes, out_bytes, offsets, {offset, removed_size, inserted});
+
+                utxt::offset_map_t new_offsets(4);
+                expect( out_bytes==utxt::reencode<INENC,OUTENC>(in_bytes, new_offsets) );
+                expect( std::string_view(out_bytes).substr(0,changed.offset)==std::string_view(old_out_bytes).substr(0,changed.offset) );
+                expect( std::string_view(out_bytes).substr(changed.offset+changed.inserted_size)==std::string_view(old_out_bytes).substr(changed.offset+changed.removed_size) );
+                for( const auto& cp : offsets.checkpoints() )
+                   {
+                    expect( that % utxt::reencode<INENC,OUTENC>(std::string_view(in_bytes).substr(0,cp.in_offset)).size()==cp.out_offset );
+                   }
+               }
+           };
+        check_edits.template operator()<UTF8,UTF16LE>();
+        check_edits.template operator()<UTF16LE,UTF8>();
+        check_edits.template operator()<UTF16BE,UTF32LE>();
+        check_edits.template operator()<UTF32BE,UTF8>();
+       };
+   };
+
+ut::test("utxt::encode_to") = []
+   {
+    std::string bytes = "log: ";
+    utxt::encode_to<UTF8>(U"aà⟶"sv, std::back_inserter(bytes));
+    utxt::encode_to<UTF8>(u"🍌"sv, std::back_inserter(bytes));
+    utxt::encode_to<UTF8>(U'⛵', std::back_inserter(bytes));
+    utxt::encode_to<UTF8>(utxt::as<UTF16BE>("\0b\0"sv), std::back_inserter(bytes));
+    expect( bytes=="log: aà⟶🍌⛵b\uFFFD"sv );
+
+    std::array<char,8> buf{};
+    const auto end = utxt::reencode_to<UTF8,UTF16BE>("a🍌"sv, buf.begin());
+    expect( std::string_view(buf.begin(), end)=="\0a\xD8\x3C\xDF\x4C"sv );
+
+    std::ostringstream os;
+    os << utxt::as_utf8(U"aà⟶"sv) << '|' << utxt::as_utf8(u"🍌"sv) << '|' << utxt::as<UTF32LE>("a\0\0\0"sv) << '|' << utxt::as<UTF8>("\xC3"sv);
+    expect( os.str()=="aà⟶|🍌|a|\xC3"sv ) << "utf-8 bytes should be written as they are\n";
+
+  #if defined(TEST_STD_FORMAT) // Defined by the CI builds, where the formatters must be tested
+    static_assert( __cpp_lib_format>=201907L, "std::format not available, formatters not tested" );
+  #endif
+  #if defined(__cpp_lib_format)
+    expect( std::format("{}-{}", utxt::as_utf8(U"aà⟶"sv), utxt::as<UTF16LE>("\x3C\xD8\x4C\xDF"sv))=="aà⟶-🍌"sv );
+    std::string formatted;
+    std::format_to(std::back_inserter(formatted), "[{}]", utxt::as_utf8(u"è"sv));
+    expect( formatted=="[è]"sv );
+    expect( std::format("{}", utxt::as<UTF8>("\xC3"sv))=="\xC3"sv );
+
+    bool rejected = false;
+    try{
+        const auto txt = utxt::as_utf8(U"a"sv);
+        [[maybe_unused]] const std::string s = std::vformat("{:>4}", std::make_format_args(txt));
+       }
+    catch( const std::format_error& ) { rejected = true; }
+    expect( rejected ) << "Format specifiers should be rejected\n";
+  #endif
+   };
+
+ut::test("utxt::split_at_boundaries") = []
+   {
+    static_assert( std::forward_iterator<utxt::frames_t<UTF8>::iterator> and std::sentinel_for<std::default_sentinel_t,utxt::frames_t<UTF8>::iterator> );
+    static_assert( std::input_iterator<utxt::transcoded_frames_t<UTF8,UTF16BE>::iterator> );
+
+    ut::test("frames") = []
+       {
+        static_assert( []{ std::size_t n=0; for( [[maybe_unused]] const auto frame : utxt::split_at_boundaries<UTF8>(""sv, 4) ) ++n; return n; }()==0 );
+
+        std::vector<std::string_view> frames;
+        for( const std::string_view frame : utxt::split_at_boundaries<UTF8>("aà⟶🍌b"sv, 4) ) frames.push_back(frame);
+        expect( frames==std::vector<std::string_view>{"aà"sv, "⟶"sv, "🍌"sv, "b"sv} );
+
+        frames.clear();
+        const std::string u16bytes = utxt::encode_as<UTF16BE>(U"ab🍌c"sv);
+        for( const std::string_view frame : utxt::split_at_boundaries<UTF16BE>(u16bytes, 6) ) frames.push_back(frame);
+        expect( frames.size()==2u and frames[0]=="\0a\0b"sv and frames[1]=="\xD8\x3C\xDF\x4C\0c"sv ) << "surrogate pair not cut\n";
+       };
+
+    ut::test("frames are maximal") = []
+       {
+        auto check_frames = []<utxt::Enc ENC>(const std::size_t max_bytes)
+           {
+            const std::string bytes = utxt::encode_as<ENC>(U"Aè⟶🍌 ascii text, then ж中文🍌🍌🍌 and again èèè⟶⟶ a few words"sv);
+            std::string joined;
+            for( const std::string_view frame : utxt::split_at_boundaries<ENC>(bytes, max_bytes) )
+               {
+                expect( frame.size()<=max_bytes and that % utxt::details::incomplete_tail_size<ENC>(frame)==0u );
+                joined += frame;
+                if( joined.size()<bytes.size() )
+                   {// The next codepoint doesn't fit
+                    std::size_t pos = joined.size();
+                    expect( frame.size()+utxt::encoded_size_of<ENC>(utxt::extract_codepoint<ENC>(bytes, pos))>max_bytes );
+                   }
+               }
+            expect( joined==bytes );
+           };
+        for( const std::size_t max_bytes : {4u, 5u, 7u, 64u, 1000u} )
+           {
+            check_frames.template operator()<UTF8>(max_bytes);
+            check_frames.template operator()<UTF16LE>(max_bytes);
+            check_frames.template operator()<UTF16BE>(max_bytes);
+            check_frames.template operator()<UTF32LE>(max_bytes);
+           }
+       };
+
+    ut::test("transcoded frames") = []
+       {
+        const std::string bytes = "sms: aà⟶🍌🍌 and more text"s;
+        std::string joined;
+        for( const std::string& frame : utxt::split_at_boundaries<UTF8,UTF16BE>(bytes, 10) )
+           {
+            expect( frame.size()<=10u and that % utxt::details::incomplete_tail_size<UTF16BE>(frame)==0u );
+            joined += frame;
+           }
+        expect( joined==utxt::reencode<UTF8,UTF16BE>(bytes) );
+
+        std::vector<std::string> frames;
+        for( const std::string& frame : utxt::split_at_boundaries<UTF16LE,UTF8>("a\0\x3C\xD8"sv, 4) ) frames.push_back(frame);
+        expect( frames==std::vector<std::string>{"a\uFFFD"s} ) << "truncated input\n";
+       };
+   };
+
+ut::test("utxt::scan_identifier") = []
+   {
+    ut::test("xid properties") = []
+       {
+        static_assert( utxt::is_xid_start(U'a') and not utxt::is_xid_start(U'1') and utxt::is_xid_continue(U'1') );
+        expect( utxt::is_xid_start(U'ж') and utxt::is_xid_start(U'中') and utxt::is_xid_start(U'\U00020000') );
+        expect( not utxt::is_xid_start(U'_') and utxt::is_xid_continue(U'_') );
+        expect( not utxt::is_xid_start(U'\u0301') and utxt::is_xid_continue(U'\u0301') ) << "combining accent\n";
+        expect( not utxt::is_xid_start(U'\U000E0100') and utxt::is_xid_continue(U'\U000E0100') );
+        expect( not utxt::is_xid_continue(U'🍌') and not utxt::is_xid_continue(U' ') and not utxt::is_xid_continue(U'\uFFFD') );
+        expect( not utxt::is_xid_continue(char32_t{0x110000}) );
+
+        // The trie agrees with the tables at the ranges boundaries
+        expect( std::ranges::all_of(utxt::details::xid_block_index, [](const std::uint8_t idx) noexcept { return idx<std::size(utxt::details::xid_blocks); }) );
+        for( const auto& range : utxt::details::xid_start_ranges )
+           {
+            expect( utxt::is_xid_start(range.first) and utxt::is_xid_start(range.last) );
+            expect( not utxt::is_xid_start(static_cast<char32_t>(range.first-1)) and not utxt::is_xid_start(static_cast<char32_t>(range.last+1)) );
+           }
+        for( const auto& range : utxt::details::xid_continue_ranges )
+           {
+            expect( utxt::is_xid_continue(range.first) and utxt::is_xid_continue(range.last) );
+            expect( not utxt::is_xid_continue(static_cast<char32_t>(range.first-1)) and not utxt::is_xid_continue(static_cast<char32_t>(range.last+1)) );
+           }
+
+        // ...and at every codepoint
+        auto in_ranges = [](const char32_t codepoint, const auto& ranges) noexcept -> bool
+           {
+            const auto it = std::ranges::upper_bound(ranges, codepoint, {}, &utxt::details::codepoint_range_t::first);
+            return it!=std::begin(ranges) and codepoint<=(it-1)->last;
+           };
+        std::size_t disagreements = 0;
+        for( char32_t codepoint=0; codepoint<0x110000; ++codepoint )
+           {
+            disagreements += utxt::is_xid_start(codepoint)!=in_ranges(codepoint, utxt::details::xid_start_ranges);
+            disagreements += utxt::is_xid_continue(codepoint)!=in_ranges(codepoint, utxt::details::xid_continue_ranges);
+           }
+        expect( that % disagreements==0u );
+       };
+
+    ut::test("identifiers") = []
+       {
+        static_assert( utxt::scan_identifier<UTF8>("abc+1"sv, 0)==3 );
+
+        auto check_scan = []<utxt::Enc ENC>()
+           {
+            struct test_case_t final { std::u32string_view text; std::size_t start; std::size_t identifier_size; };
+            constexpr std::array<test_case_t,9> test_cases =
+               {{
+                 { U"foo_bar1 = 2"sv, 0, 8 }
+                ,{ U"1abc"sv, 0, 0 }
+                ,{ U"_x"sv, 0, 2 }
+                ,{ U"a = αβγ+1"sv, 4, 3 }
+                ,{ U"very_long_identifier_withé_and_more_words(x)"sv, 0, 41 }
+                ,{ U"x1234567890123456789012345678901234567890"sv, 0, 41 }
+                ,{ U"naïve_Ä1́ "sv, 0, 9 }
+                ,{ U"ab🍌cd"sv, 0, 2 }
+                ,{ U""sv, 0, 0 }
+               }};
+            for( const test_case_t& test_case : test_cases )
+               {
+                const std::string bytes = utxt::encode_as<ENC>(test_case.text);
+                const std::size_t start = utxt::encode_as<ENC>(test_case.text.substr(0, test_case.start)).size();
+                const std::size_t end = utxt::encode_as<ENC>(test_case.text.substr(0, test_case.start+test_case.identifier_size)).size();
+                expect( that % utxt::scan_identifier<ENC>(bytes, start)==end );
+               }
+           };
+        check_scan.template operator()<UTF8>();
+        check_scan.template operator()<UTF16LE>();
+        check_scan.template operator()<UTF16BE>();
+        check_scan.template operator()<UTF32LE>();
+        check_scan.template operator()<UTF32BE>();
+
+        expect( that % utxt::scan_identifier<UTF8>("abc\xE2\x9F"sv, 0)==3u ) << "invalid utf-8\n";
+        expect( that % utxt::scan_identifier<UTF16LE>("a\0b\0c"sv, 0)==4u ) << "truncated code unit\n";
+       };
+   };
+
+ut::test("utxt::transcoding_streambuf_t") = []
+   {
+    ut::test("reading") = []
+       {
+        const std::string utf8 = "first line: aà⟶🍌\nsecond line\n🍌"s;
+        std::stringbuf device("\xFF\xFE"s + utxt::reencode<UTF8,UTF16LE>(utf8)); // With bom
+        utxt::transcoding_streambuf_t<UTF16LE,UTF8> buf(device, utxt::flag::SKIP_BOM, 3); // Blocks that split codepoints
+        std::istream is(&buf);
+        std::string line;
+        expect( std::getline(is, line) and line=="first line: aà⟶🍌"sv );
+        expect( std::getline(is, line) and line=="second line"sv );
+        expect( std::getline(is, line) and line=="🍌"sv );
+        expect( not std::getline(is, line) );
+       };
+
+    ut::test("reading truncated") = []
+       {
+        std::stringbuf device("\xE2\x9F\xB6" "a\xE2"s); // "⟶a" and a truncated codepoint
+        utxt::transcoding_streambuf_t<UTF8,UTF32BE> buf(device, utxt::flag::SKIP_BOM, 2);
+        std::istream is(&buf);
+        const std::string decoded{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+        expect( decoded=="\0\0\x27\xF6\0\0\0a\0\0\xFF\xFD"sv );
+       };
+
+    ut::test("writing") = []
+       {
+        std::stringbuf device;
+        {
+            utxt::transcoding_streambuf_t<UTF16BE,UTF8> buf(device, utxt::flag::NONE, 2);
+            std::ostream os(&buf);
+            os << "aà" << "\xF0\x9F" << std::flush; // Half codepoint
+            expect( device.str()=="\0a\0\xE0"sv );
+            os << "\x8D\x8C\n" << std::flush;
+            expect( device.str()=="\0a\0\xE0\xD8\x3C\xDF\x4C\0\n"sv );
+            os << "\xE2";
+        }
+        expect( device.str()=="\0a\0\xE0\xD8\x3C\xDF\x4C\0\n\xFF\xFD"sv ) << "Truncated codepoint flushed on destruction\n";
+       };
    };
 
 };///////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,559 @@
+﻿//  ---------------------------------------------
+//  utxt: transcode text files and directories
+//  ---------------------------------------------
+//  $ g++ -std=c++23 -O2 -o utxt utxt.cpp
+//  $ utxt -t utf-8 -s -o out-dir in-dir
+//  ---------------------------------------------
+#include <cstdio> // std::fprintf(), std::fwrite()
+#include <cstdint> // std::uint64_t
+#include <string>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <deque>
+#include <set>
+#include <optional>
+#include <mutex>
+#include <thread>
+#include <functional> // std::ref(), std::cref()
+#include <atomic>
+#include <chrono>
+#include <charconv> // std::from_chars()
+#include <fstream>
+#include <filesystem>
+#if defined(_WIN32)
+  #include <io.h> // _setmode(), _fileno()
+  #include <fcntl.h> // _O_BINARY
+#else
+  #include <iconv.h> // iconv_open(), iconv(), iconv_close()
+  #include <cerrno> // errno, E2BIG
+#endif
+
+#include "unicode_text.hpp" // utxt::*
+
+namespace fs = std::filesystem;
+
+
+//---------------------------------------------------------------------------
+void print_usage()
+{
+    std::fprintf(stderr, "Usage: utxt -t <encoding> [-s] [-j <threads>] [-o <output>|-n] [-q] [--iconv] <input>...\n"
+                         "  -t, --to <encoding>  Output encoding: utf-8, utf-16le, utf-16be, utf-32le, utf-32be\n"
+                         "  -s, --skip-bom       Skip the byte order mark of the input\n"
+                         "  -o, --output <path>  Output file, or directory when inputs are more or directories\n"
+                         "  -n, --no-output      Just transcode, to measure the throughput\n"
+                         "  -j, --jobs <n>       Number of threads, by default the hardware ones\n"
+                         "  -q, --quiet          Don't print the throughput report\n"
+                       #if !defined(_WIN32)
+                         "      --iconv          Transcode with the system iconv, to compare the throughput\n"
+                       #endif
+                         "The input encoding is detected by its byte order mark, utf-8 if none.\n"
+                         "Without an output, a single input file is written to stdout.\n");
+}
+
+
+//---------------------------------------------------------------------------
+// Encoding names are case insensitive, dashes and underscores are ignored
+[[nodiscard]] std::optional<utxt::Enc> enc_of_name(const std::string_view name)
+{
+    std::string id;
+    for( const char ch : name )
+       {
+        if( ch>='A' and ch<='Z' ) id.push_back(static_cast<char>(ch - 'A' + 'a'));
+        else if( ch!='-' and ch!='_' ) id.push_back(ch);
+       }
+
+    using enum utxt::Enc;
+    if( id=="utf8" ) return UTF8;
+    else if( id=="utf16le" ) return UTF16LE;
+    else if( id=="utf16be" ) return UTF16BE;
+    else if( id=="utf32le" ) return UTF32LE;
+    else if( id=="utf32be" ) return UTF32BE;
+    return std::nullopt;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+struct options_t final
+   {
+    utxt::Enc out_enc = utxt::Enc::UTF8;
+    utxt::flags_t flags = utxt::flag::NONE;
+    fs::path output;
+    bool no_output = false;
+    bool quiet = false;
+    bool use_iconv = false;
+    unsigned int threads_count = 0;
+    std::vector<fs::path> inputs;
+   };
+
+//---------------------------------------------------------------------------
+[[nodiscard]] std::optional<options_t> parse_args(const int argc, const char* const argv[])
+{
+    options_t options;
+    bool got_enc = false;
+
+    for( int i=1; i<argc; ++i )
+       {
+        const std::string_view arg = argv[i];
+        auto next_arg = [&i, argc, argv, arg]() -> std::optional<std::string_view>
+           {
+            if( i+1<argc ) return std::string_view(argv[++i]);
+            std::fprintf(stderr, "utxt: %s needs a value\n", arg.data());
+            return std::nullopt;
+           };
+
+        if( arg=="-t" or arg=="--to" )
+           {
+            const auto val = next_arg();
+            if( not val ) return std::nullopt;
+            const auto enc = enc_of_name(*val);
+            if( not enc )
+               {
+                std::fprintf(stderr, "utxt: unknown encoding %s\n", val->data());
+                return std::nullopt;
+               }
+            options.out_enc = *enc;
+            got_enc = true;
+           }
+        else if( arg=="-s" or arg=="--skip-bom" )
+           {
+            options.flags |= utxt::flag::SKIP_BOM;
+           }
+        else if( arg=="-o" or arg=="--output" )
+           {
+            const auto val = next_arg();
+            if( not val ) return std::nullopt;
+            options.output = *val;
+           }
+        else if( arg=="-n" or arg=="--no-output" )
+           {
+            options.no_output = true;
+           }
+        else if( arg=="-j" or arg=="--jobs" )
+           {
+            const auto val = next_arg();
+            if( not val ) return std::nullopt;
+            const auto [ptr, ec] = std::from_chars(val->data(), val->data()+val->size(), options.threads_count);
+            if( ec!=std::errc{} or ptr!=val->data()+val->size() or options.threads_count==0 )
+               {
+                std::fprintf(stderr, "utxt: invalid number of jobs %s\n", val->data());
+                return std::nullopt;
+               }
+           }
+        else if( arg=="-q" or arg=="--quiet" )
+           {
+            options.quiet = true;
+           }
+      #if !defined(_WIN32)
+        else if( arg=="--iconv" )
+           {
+            options.use_iconv = true;
+           }
+      #endif
+        else if( arg.starts_with('-') and arg.size()>1 )
+           {
+            std::fprintf(stderr, "utxt: unknown option %s\n", arg.data());
+            return std::nullopt;
+           }
+        else
+           {
+            options.inputs.emplace_back(arg);
+           }
+       }
+
+    if( not got_enc or options.inputs.empty() )
+       {
+        return std::nullopt;
+       }
+
+    if( options.no_output and not options.output.empty() )
+       {
+        std::fprintf(stderr, "utxt: either an output or --no-output\n");
+        return std::nullopt;
+       }
+
+    return options;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// A file to transcode, an empty output means stdout
+struct job_t final
+   {
+    fs::path input;
+    fs::path output;
+   };
+
+//---------------------------------------------------------------------------
+// Expand the inputs in the files to transcode, keeping
+// the relative paths of the files found in directories.
+// Two jobs can't write the same output, one would be lost
+[[nodiscard]] std::optional<std::vector<job_t>> collect_jobs(const options_t& options)
+{
+    std::vector<job_t> jobs;
+
+    bool to_dir = options.inputs.size()>1;
+    for( const fs::path& input : options.inputs )
+       {
+        if( fs::is_directory(input) ) to_dir = true;
+       }
+    if( not options.output.empty() and fs::is_directory(options.output) ) to_dir = true;
+
+    if( to_dir and options.output.empty() and not options.no_output )
+       {
+        std::fprintf(stderr, "utxt: an output directory is needed\n");
+        return std::nullopt;
+       }
+
+    for( const fs::path& input : options.inputs )
+       {
+        std::error_code ec;
+        if( fs::is_directory(input, ec) )
+           {
+            for( fs::recursive_directory_iterator it(input, ec), end; not ec and it!=end; it.increment(ec) )
+               {
+                if( it->is_regular_file(ec) )
+                   {
+                    jobs.push_back({ it->path(), options.no_output ? fs::path{} : options.output / fs::relative(it->path(), input, ec) });
+                   }
+               }
+           }
+        else if( fs::is_regular_file(input, ec) )
+           {
+            jobs.push_back({ input, options.no_output ? fs::path{}
+                                  : to_dir ? options.output / input.filename()
+                                  : options.output });
+           }
+        else
+           {
+            std::fprintf(stderr, "utxt: cannot read %s\n", input.string().c_str());
+            return std::nullopt;
+           }
+
+        if( ec )
+           {
+            std::fprintf(stderr, "utxt: %s: %s\n", input.string().c_str(), ec.message().c_str());
+            return std::nullopt;
+           }
+       }
+
+    if( not options.no_output )
+       {
+        std::set<fs::path> outputs;
+        for( const job_t& job : jobs )
+           {
+            if( not outputs.insert(job.output.lexically_normal()).second )
+               {
+                std::fprintf(stderr, "utxt: %s would be written more than once\n", job.output.string().c_str());
+                return std::nullopt;
+               }
+           }
+       }
+
+    return jobs;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// A queue of jobs for each thread: a thread takes its own jobs from
+// the back and, when done, steals the others' jobs from the front
+class work_queues_t final
+{
+ private:
+    struct queue_t final
+       {
+        std::mutex mutex;
+        std::deque<job_t> jobs;
+       };
+    std::vector<queue_t> m_queues;
+
+ public:
+    explicit work_queues_t(const std::size_t threads_count)
+      : m_queues(threads_count)
+       {}
+
+    //-----------------------------------------------------------------------
+    // Deal the jobs as cards (no locks, before starting the threads)
+    void deal(std::vector<job_t>&& jobs)
+       {
+        for( std::size_t i=0; i<jobs.size(); ++i )
+           {
+            m_queues[i % m_queues.size()].jobs.push_back( std::move(jobs[i]) );
+           }
+       }
+
+    //-----------------------------------------------------------------------
+    [[nodiscard]] std::optional<job_t> take(const std::size_t thread_idx)
+       {
+        {
+         queue_t& own = m_queues[thread_idx];
+         const std::lock_guard<std::mutex> lock(own.mutex);
+         if( not own.jobs.empty() )
+            {
+             job_t job = std::move(own.jobs.back());
+             own.jobs.pop_back();
+             return job;
+            }
+        }
+
+        for( std::size_t i=1; i<m_queues.size(); ++i )
+           {
+            queue_t& other = m_queues[(thread_idx + i) % m_queues.size()];
+            const std::lock_guard<std::mutex> lock(other.mutex);
+            if( not other.jobs.empty() )
+               {
+                job_t job = std::move(other.jobs.front());
+                other.jobs.pop_front();
+                return job;
+               }
+           }
+
+        // No jobs are added while working, so we're done
+        return std::nullopt;
+       }
+};
+
+
+#if !defined(_WIN32)
+/////////////////////////////////////////////////////////////////////////////
+// Transcodes as utxt::encode_if_necessary_as() but with the system iconv,
+// to compare the two on the same jobs. Unlike utxt, iconv fails on the
+// invalid sequences instead of replacing them
+class iconv_transcoder_t final
+{
+ private:
+    static inline const iconv_t not_open = reinterpret_cast<iconv_t>(-1);
+    utxt::Enc m_out_enc;
+    std::array<iconv_t,5> m_descriptors; // For each input encoding, opened when needed
+
+ public:
+    explicit iconv_transcoder_t(const utxt::Enc out_enc) noexcept
+      : m_out_enc(out_enc)
+       {
+        m_descriptors.fill(not_open);
+       }
+
+    ~iconv_transcoder_t()
+       {
+        for( const iconv_t descriptor : m_descriptors )
+           {
+            if( descriptor!=not_open ) iconv_close(descriptor);
+           }
+       }
+
+    iconv_transcoder_t(const iconv_transcoder_t&) = delete;
+    iconv_transcoder_t& operator=(const iconv_transcoder_t&) = delete;
+
+    //-----------------------------------------------------------------------
+    [[nodiscard]] std::optional<std::string_view> encode_if_necessary(std::string_view in_bytes, std::string& reencoded_buf, const utxt::flags_t flags)
+       {
+        const auto [in_enc, bom_size] = utxt::detect_encoding_of(in_bytes);
+        if( flags & utxt::flag::SKIP_BOM )
+           {
+            in_bytes.remove_prefix(bom_size);
+           }
+        if( in_enc==m_out_enc )
+           {
+            return in_bytes;
+           }
+
+        iconv_t& descriptor = m_descriptors[static_cast<std::size_t>(in_enc)];
+        if( descriptor==not_open )
+           {
+            descriptor = iconv_open(name_of(m_out_enc), name_of(in_enc));
+            if( descriptor==not_open ) return std::nullopt;
+           }
+        else
+           {
+            iconv(descriptor, nullptr, nullptr, nullptr, nullptr); // Reset the state
+           }
+
+        // iconv doesn't modify the input despite the signature
+        char* in_ptr = const_cast<char*>(in_bytes.data());
+        std::size_t in_left = in_bytes.size();
+        std::size_t out_size = 0;
+        reencoded_buf.resize( 2*in_bytes.size() + 16 );
+        while( true )
+           {
+            char* out_ptr = reencoded_buf.data() + out_size;
+            std::size_t out_left = reencoded_buf.size() - out_size;
+            const std::size_t ret = iconv(descriptor, &in_ptr, &in_left, &out_ptr, &out_left);
+            out_size = reencoded_buf.size() - out_left;
+            if( ret!=static_cast<std::size_t>(-1) ) break;
+            if( errno!=E2BIG ) return std::nullopt;
+            reencoded_buf.resize( 2*reencoded_buf.size() );
+           }
+        reencoded_buf.resize(out_size);
+        return reencoded_buf;
+       }
+
+ private:
+    [[nodiscard]] static constexpr const char* name_of(const utxt::Enc enc) noexcept
+       {
+        switch(enc)
+           {using enum utxt::Enc;
+            case UTF8:    return "UTF-8";
+            case UTF16LE: return "UTF-16LE";
+            case UTF16BE: return "UTF-16BE";
+            case UTF32LE: return "UTF-32LE";
+            case UTF32BE: return "UTF-32BE";
+           }
+        std::unreachable();
+       }
+};
+#endif
+
+
+/////////////////////////////////////////////////////////////////////////////
+struct totals_t final
+   {
+    std::atomic<std::uint64_t> files_count{0};
+    std::atomic<std::uint64_t> in_bytes{0};
+    std::atomic<std::uint64_t> out_bytes{0};
+    std::atomic<std::uint64_t> failures_count{0};
+   };
+
+//---------------------------------------------------------------------------
+[[nodiscard]] bool read_file(const fs::path& path, std::string& bytes)
+{
+    std::ifstream file(path, std::ios::binary);
+    if( not file ) return false;
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if( ec ) return false;
+    bytes.resize( static_cast<std::size_t>(size) );
+    file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    bytes.resize( static_cast<std::size_t>(file.gcount()) );
+    return not file.bad();
+}
+
+//---------------------------------------------------------------------------
+[[nodiscard]] bool write_file(const fs::path& path, const std::string_view bytes)
+{
+    std::error_code ec;
+    if( path.has_parent_path() ) fs::create_directories(path.parent_path(), ec);
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return file.good();
+}
+
+//---------------------------------------------------------------------------
+[[nodiscard]] bool write_stdout(const std::string_view bytes)
+{
+  #if defined(_WIN32)
+    _setmode(_fileno(stdout), _O_BINARY);
+  #endif
+    return std::fwrite(bytes.data(), 1, bytes.size(), stdout)==bytes.size() and std::fflush(stdout)==0;
+}
+
+//---------------------------------------------------------------------------
+void transcode_jobs(work_queues_t& queues, const std::size_t thread_idx, const options_t& options, totals_t& totals)
+{
+    // Buffers reused across the files
+    std::string in_bytes, reencoded_buf;
+  #if !defined(_WIN32)
+    std::optional<iconv_transcoder_t> iconv_transcoder;
+    if( options.use_iconv ) iconv_transcoder.emplace(options.out_enc);
+  #endif
+
+    while( auto job = queues.take(thread_idx) )
+       {
+        if( not read_file(job->input, in_bytes) )
+           {
+            std::fprintf(stderr, "utxt: cannot read %s\n", job->input.string().c_str());
+            ++totals.failures_count;
+            continue;
+           }
+
+      #if !defined(_WIN32)
+        const std::optional<std::string_view> transcoded = iconv_transcoder ? iconv_transcoder->encode_if_necessary(in_bytes, reencoded_buf, options.flags)
+                                                         : utxt::encode_if_necessary_as(options.out_enc, in_bytes, reencoded_buf, options.flags);
+        if( not transcoded )
+           {
+            std::fprintf(stderr, "utxt: iconv cannot transcode %s\n", job->input.string().c_str());
+            ++totals.failures_count;
+            continue;
+           }
+        const std::string_view out_bytes = *transcoded;
+      #else
+        const std::string_view out_bytes = utxt::encode_if_necessary_as(options.out_enc, in_bytes, reencoded_buf, options.flags);
+      #endif
+
+        if( not options.no_output )
+           {
+            if( not (job->output.empty() ? write_stdout(out_bytes) : write_file(job->output, out_bytes)) )
+               {
+                std::fprintf(stderr, "utxt: cannot write %s\n", job->output.empty() ? "stdout" : job->output.string().c_str());
+                ++totals.failures_count;
+                continue;
+               }
+           }
+
+        ++totals.files_count;
+        totals.in_bytes += in_bytes.size();
+        totals.out_bytes += out_bytes.size();
+       }
+}
+
+//---------------------------------------------------------------------------
+void print_report(const char* const transcoder, const totals_t& totals, const double seconds)
+{
+    const double files = static_cast<double>(totals.files_count.load());
+    const double in_gb = static_cast<double>(totals.in_bytes.load()) / 1E9;
+    const double out_gb = static_cast<double>(totals.out_bytes.load()) / 1E9;
+    const double secs = seconds>0.0 ? seconds : 1E-9;
+    std::fprintf(stderr, "%s: %.0f files, %.3f GB in, %.3f GB out, %.3f s: %.1f files/s, %.3f GB/s\n",
+                 transcoder, files, in_gb, out_gb, seconds, files/secs, in_gb/secs);
+    if( const auto failures_count=totals.failures_count.load(); failures_count>0 )
+       {
+        std::fprintf(stderr, "utxt: %llu files failed\n", static_cast<unsigned long long>(failures_count));
+       }
+}
+
+
+//---------------------------------------------------------------------------
+int main(const int argc, const char* const argv[])
+{
+    const auto options = parse_args(argc, argv);
+    if( not options )
+       {
+        print_usage();
+        return 2;
+       }
+
+    auto jobs = collect_jobs(*options);
+    if( not jobs )
+       {
+        return 2;
+       }
+
+    // Writing to stdout must keep the inputs order
+    const bool to_stdout = not options->no_output and jobs->size()==1 and jobs->front().output.empty();
+    std::size_t threads_count = to_stdout ? 1u
+                              : options->threads_count>0 ? options->threads_count
+                              : std::max(1u, std::thread::hardware_concurrency());
+    threads_count = std::max<std::size_t>(1, std::min(threads_count, jobs->size()));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    totals_t totals;
+    work_queues_t queues(threads_count);
+    queues.deal( std::move(*jobs) );
+    {
+     std::vector<std::jthread> threads;
+     threads.reserve(threads_count - 1);
+     for( std::size_t i=1; i<threads_count; ++i )
+        {
+         threads.emplace_back(transcode_jobs, std::ref(queues), i, std::cref(*options), std::ref(totals));
+        }
+     transcode_jobs(queues, 0, *options, totals);
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if( not options->quiet )
+       {
+        print_report(options->use_iconv ? "iconv" : "utxt", totals, elapsed.count());
+       }
+
+    return totals.failures_count>0 ? 1 : 0;
+}